@@ -4,6 +4,10 @@
 CC_CMACH	= -mmcu=cc430f6137
 CC_DMACH	= -D__MSP430_6137__ -DMRFI_CC430 -D__CC430F6137__
 
+# RAM of the cc430f6137 and the part of it kept for the stack (see tools/firmware/ramcheck.py)
+RAM_SIZE	= 4096
+STACK_SIZE	?= 512
+
 
 # *************************************************************************************************
 # Build flags
@@ -13,6 +17,9 @@ CFLAGS		+= -fno-force-addr -finline-limit=1 -fno-schedule-insns
 CFLAGS		+= -fshort-enums -Wl,-Map=output.map
 LDFLAGS		=
 
+# No heap: any use of malloc and friends fails to link (undefined __wrap_malloc...)
+LDFLAGS		+= -Wl,--wrap=malloc -Wl,--wrap=free -Wl,--wrap=calloc -Wl,--wrap=realloc
+
 # Release flags (Use dead code elimination flags. @see: http://gcc.gnu.org/ml/gcc-help/2003-08/msg00128.html)
 CFLAGS_REL	+= -Os -fdata-sections -ffunction-sections -fomit-frame-pointer
 LDFLAGS_REL	+= -Wl,--gc-sections -Wl,-s
@@ -0,0 +1,254 @@
+/**
+	@file	alarms.c
+	@brief	Alarm scheduler
+
+	@see		http://www.openchronos-ng.sourceforge.net
+	@copyright
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+
+// *************************************************************************************************
+// Include section
+
+#include <core/alarms.h>
+
+#ifdef CONFIG_RTC_IRQ
+
+#include <drivers/rtca.h>
+
+#ifdef CONFIG_INFOMEM
+#include <drivers/infomem.h>
+#endif
+
+
+// *************************************************************************************************
+// Defines section
+
+/// Minutes in a week, larger than any time until an alarm
+#define ALARMS_WEEK		(7 * 24 * 60u)
+
+
+// *************************************************************************************************
+// Global Variable section
+
+/// The table, also seen as words for the infomem driver
+static union
+{
+	struct alarm a[ALARMS_COUNT];
+	uint16_t words[ALARMS_COUNT * sizeof(struct alarm) / 2];
+} alarms;
+
+/// Alarms that rang with the last SYS_MSG_ALARM
+static uint8_t alarms_fired_mask;
+
+
+// *************************************************************************************************
+// Functions section
+
+//* ************************************************************************************************
+/// @fn			alarms_until
+/// @brief		Minutes from \b now (minutes since sunday 00:00) until the next time the alarm
+///				rings, the current minute excluded.
+/// @return		Minutes from 1 to a week, #ALARMS_WEEK if the alarm never rings
+//* ************************************************************************************************
+static uint16_t alarms_until(const struct alarm *alarm, uint16_t now)
+{
+	uint16_t at = alarm->hour * 60u + alarm->min;
+	uint8_t dow = now / (24 * 60u);
+	uint16_t until;
+	uint8_t d = 0;
+
+	if (!(alarm->flags & ALARM_ON) || !alarm->days)
+		return ALARMS_WEEK;
+
+	// Today is counted twice, now and a week later
+	for (; d <= 7; d++, dow = (dow == 6 ? 0 : dow + 1))
+	{
+		if (!(alarm->days & (1 << dow)))
+			continue;
+
+		until = d * (24 * 60u) + at - (now % (24 * 60u));
+
+		if (at > now % (24 * 60u) || d > 0)
+			return until;
+	}
+
+	return ALARMS_WEEK;
+}
+
+//* ************************************************************************************************
+/// @fn			alarms_program
+/// @brief		Program the nearest alarm into the RTC, or disable the RTC alarm.
+/// @return		none
+//* ************************************************************************************************
+void alarms_program(void)
+{
+	uint16_t now = (rtca_time.dow * 24u + rtca_time.hour) * 60u + rtca_time.min;
+	uint16_t nearest = ALARMS_WEEK;
+	uint16_t until;
+	uint8_t next = 0;
+	uint8_t n = 0;
+
+	for (; n < ALARMS_COUNT; n++)
+	{
+		until = alarms_until(&alarms.a[n], now);
+
+		if (until < nearest)
+		{
+			nearest = until;
+			next = n;
+		}
+	}
+
+	if (nearest == ALARMS_WEEK)
+	{
+		rtca_disable_alarm();
+		return;
+	}
+
+	// The day of week of the alarm, the hour and minute are those of the table
+	now += nearest;
+	if (now >= ALARMS_WEEK)
+		now -= ALARMS_WEEK;
+
+	rtca_set_alarm_dow(now / (24 * 60u), alarms.a[next].hour, alarms.a[next].min);
+}
+
+//* ************************************************************************************************
+/// @fn			alarms_save
+/// @brief		Save the table to the information memory.
+/// @return		none
+//* ************************************************************************************************
+static void alarms_save(void)
+{
+#ifdef CONFIG_INFOMEM
+	infomem_app_replace(ALARMS_INFOMEM_ID, alarms.words, sizeof(alarms.words) / 2);
+#endif
+}
+
+//* ************************************************************************************************
+/// @fn			alarms_event
+/// @brief		Find the alarms due now, turn off the one-shot ones and program the next one.
+/// @return		none
+//* ************************************************************************************************
+static void alarms_event(enum sys_message msg)
+{
+	struct alarm *alarm = alarms.a;
+	uint8_t fired = 0;
+	uint8_t oneshot = 0;
+	uint8_t n = 0;
+
+	for (; n < ALARMS_COUNT; n++, alarm++)
+	{
+		if ((alarm->flags & ALARM_ON) && (alarm->days & (1 << rtca_time.dow))
+			&& alarm->hour == rtca_time.hour && alarm->min == rtca_time.min)
+		{
+			fired |= 1 << n;
+
+			if (!(alarm->flags & ALARM_REPEAT))
+			{
+				alarm->flags &= ~ALARM_ON;
+				oneshot = 1;
+			}
+		}
+	}
+
+	if (oneshot)
+		alarms_save();
+
+	alarms_program();
+
+	// The RTC alarm was programmed before the clock was set
+	if (!fired)
+		return;
+
+	alarms_fired_mask = fired;
+
+	__disable_interrupt();
+	sys_messagebus_post(SYS_MSG_ALARM);
+	__enable_interrupt();
+}
+
+//* ************************************************************************************************
+/// @fn			alarms_init
+/// @brief		Restore the table from the information memory and program the RTC.
+/// @return		none
+//* ************************************************************************************************
+void alarms_init(void)
+{
+#ifdef CONFIG_INFOMEM
+	if (infomem_app_amount(ALARMS_INFOMEM_ID) == sizeof(alarms.words) / 2)
+		infomem_app_read(ALARMS_INFOMEM_ID, alarms.words, sizeof(alarms.words) / 2, 0);
+#endif
+
+	alarms_program();
+
+	sys_messagebus_register(&alarms_event, SYS_MSG_RTC_ALARM);
+}
+
+//* ************************************************************************************************
+/// @fn			alarms_get
+/// @brief		Alarm \b n of the table.
+/// @return		The alarm
+//* ************************************************************************************************
+const struct alarm *alarms_get(uint8_t n)
+{
+	return &alarms.a[n];
+}
+
+//* ************************************************************************************************
+/// @fn			alarms_set
+/// @brief		Replace alarm \b n, save the table and program the RTC.
+/// @return		none
+//* ************************************************************************************************
+void alarms_set(uint8_t n, const struct alarm *alarm)
+{
+	alarms.a[n] = *alarm;
+
+	alarms_save();
+	alarms_program();
+}
+
+//* ************************************************************************************************
+/// @fn			alarms_fired
+/// @brief		Alarms that rang with the last #SYS_MSG_ALARM.
+/// @return		Bit mask, bit 0 is alarm 0
+//* ************************************************************************************************
+uint8_t alarms_fired(void)
+{
+	return alarms_fired_mask;
+}
+
+//* ************************************************************************************************
+/// @fn			alarms_armed
+/// @brief		Tell if any alarm is on.
+/// @return		1 if any alarm is on, 0 otherwise
+//* ************************************************************************************************
+uint8_t alarms_armed(void)
+{
+	uint8_t n = 0;
+
+	for (; n < ALARMS_COUNT; n++)
+	{
+		if (alarms.a[n].flags & ALARM_ON)
+			return 1;
+	}
+
+	return 0;
+}
+
+#endif /* CONFIG_RTC_IRQ */
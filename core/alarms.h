@@ -0,0 +1,115 @@
+/**
+	@file	alarms.h
+	@brief	Alarm scheduler
+
+	@see		http://www.openchronos-ng.sourceforge.net
+	@copyright
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	@details	Keeps a table of #ALARMS_COUNT alarms, each ringing at a time of day on
+				a set of weekdays, once or every time. The RTC_A has a single alarm, only the
+				nearest alarm is programmed into it (minute, hour and day of week), so the CPU
+				is woken only when one is due. When it rings, the alarms due at that minute are
+				set in alarms_fired(), the one-shot ones are turned off, the next one is
+				programmed and #SYS_MSG_ALARM is posted to the message bus. Setting the time or
+				the date, by hand or for DST, programs the nearest alarm again.
+
+				With CONFIG_INFOMEM the table is saved in the information memory by
+				alarms_set() and restored at boot.
+ */
+
+#ifndef __ALARMS_H__
+#define __ALARMS_H__
+
+// *************************************************************************************************
+// Include section
+
+#include <core/openchronos.h>
+
+
+// *************************************************************************************************
+// Defines section
+
+/// Number of alarms in the table, 4 bytes of RAM each (at most 8)
+#ifdef CONFIG_ALARMS
+#define ALARMS_COUNT	CONFIG_ALARMS
+#else
+#define ALARMS_COUNT	4
+#endif
+
+#if ALARMS_COUNT > 8
+#error "At most 8 alarms are supported, see alarms_fired()"
+#endif
+
+/// Infomem application identifier of the alarm table
+#define ALARMS_INFOMEM_ID	0xA1
+
+///	Weekdays of struct alarm, as numbered by rtca_time.dow.
+#define ALARM_SUNDAY		BIT0
+#define ALARM_MONDAY		BIT1
+#define ALARM_TUESDAY		BIT2
+#define ALARM_WEDNESDAY		BIT3
+#define ALARM_THURSDAY		BIT4
+#define ALARM_FRIDAY		BIT5
+#define ALARM_SATURDAY		BIT6
+
+#define ALARM_WORKDAYS		(ALARM_MONDAY | ALARM_TUESDAY | ALARM_WEDNESDAY | ALARM_THURSDAY \
+							 | ALARM_FRIDAY)
+#define ALARM_WEEKEND		(ALARM_SATURDAY | ALARM_SUNDAY)
+#define ALARM_EVERYDAY		(ALARM_WORKDAYS | ALARM_WEEKEND)
+
+///	Flags of struct alarm.
+enum alarm_flags
+{
+	ALARM_ON		= BIT0,	/**< The alarm is armed */
+	ALARM_REPEAT	= BIT1,	/**< Rings on each of its days, otherwise it is turned off after ringing once */
+};
+
+
+// *************************************************************************************************
+// Global Variable section
+
+///	An alarm of the table.
+struct alarm
+{
+	uint8_t hour;		/**< 0 to 23 */
+	uint8_t min;		/**< 0 to 59 */
+	uint8_t days;		/**< Weekdays it rings on, ALARM_SUNDAY to ALARM_SATURDAY */
+	uint8_t flags;		/**< See #alarm_flags */
+};
+
+
+// *************************************************************************************************
+// Prototypes section
+
+/// Restores the table and programs the RTC, exclusive use by openchronos system.
+void alarms_init(void);
+
+/// Returns alarm \b n of the table, do not modify it.
+const struct alarm *alarms_get(uint8_t n);
+
+/// Replaces alarm \b n of the table, saves the table and programs the RTC.
+void alarms_set(uint8_t n, const struct alarm *alarm);
+
+/// Programs the nearest alarm into the RTC, queued by rtca_set_time() and rtca_set_date().
+void alarms_program(void);
+
+/// Bit mask of the alarms that rang with the last #SYS_MSG_ALARM, bit 0 is alarm 0.
+uint8_t alarms_fired(void);
+
+/// Returns 1 if any alarm is on.
+uint8_t alarms_armed(void);
+
+#endif /* __ALARMS_H__ */
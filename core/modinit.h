@@ -26,6 +26,7 @@
 // *************************************************************************************************
 // Include section
 
+#include <stdint.h>
 
 // *************************************************************************************************
 // Defines section
@@ -34,6 +35,14 @@
 // *************************************************************************************************
 // Global Variable section
 
+struct menu;
+
+/// The menu entries of the enabled modules, in flash. The first one is active at boot.
+extern const struct menu * const menu_table[];
+
+/// Number of entries in #menu_table
+extern const uint8_t menu_table_size;
+
 
 // *************************************************************************************************
 // Prototypes section
@@ -63,6 +63,12 @@
 
 #include <core/openchronos.h>
 #include <core/modinit.h>
+#include <core/pt.h>
+#include <core/profile.h>
+#include <core/stackmon.h>
+#include <core/wakestat.h>
+#include <core/trace.h>
+#include <core/alarms.h>
 
 // Drivers
 #include <drivers/display.h>
@@ -77,6 +83,7 @@
 #include <drivers/rtca.h>
 #include <drivers/temperature.h>
 #include <drivers/battery.h>
+#include <drivers/infomem.h>
 
 
 // *************************************************************************************************
@@ -84,47 +91,30 @@
 
 #define BIT_IS_SET(F, B)  ((F) | (B)) == (F)
 
+/// The currently active menu item
+#define MENU_ITEM	(menu_table[menumode.item])
+
+/// Edit mode autorepeat: first period in ms, once UP/DOWN is held past the long press time
+#define EDITMODE_REPEAT_START	200
+
+/// Edit mode autorepeat: the period is halved down to this many ms
+#define EDITMODE_REPEAT_MIN		50
+
+/// Edit mode autorepeat: repeats between two speedups
+#define EDITMODE_REPEAT_ACCEL	5
+
+/// Edit mode autorepeat: step passed to set() once the fastest period was held for a while
+#define EDITMODE_REPEAT_FAST	10
+
 
 // *************************************************************************************************
 // Global Variable section
 
-/// Menu definitions and declarations
-struct menu
-{
-	/// Menu item name
-	char const * name;
-	
-	/// Pointer to up button handler
-	void (*up_btn_fn)(void);
-	/// Pointer to down button handler
-	void (*down_btn_fn)(void);
-	/// Pointer to function button (NUM)
-	void (*num_btn_fn)(void);
-	/// Pointer to settings button (long STAR)
-	void (*lstar_btn_fn)(void);
-	/// Pointer to function button (long NUM)
-	void (*lnum_btn_fn)(void);
-	/// Pointer to simultaneous up&down press
-	void (*updown_btn_fn)(void);
-	/// Pointer to activate function
-	void (*activate_fn)(void);
-	/// Pointer to deactivate function
-	void (*deactivate_fn)(void);
-	
-	/// Pointer to next menu item
-	struct menu *next;
-	/// Pointer to the previous menu item
-	struct menu *prev;
-};
-
-/// The head of the linked list holding menu items
-static struct menu *menu_head;
-
 /// Menu mode stuff
 static struct
 {
 	uint8_t enabled:1;	/**< Is menu mode enabled ? */
-	struct menu *item;	/**< The currently active menu item */
+	uint8_t item;		/**< Index of the currently active item in #menu_table */
 } menumode;
 
 /// Menu edit mode stuff
@@ -134,10 +124,54 @@ static struct
 	uint8_t pos:7;						/**< The position for selected item */
 	void (* complete_fn)(void);			/**< Call this fn when editmode exits */
 	struct menu_editmode_item *items;	/**< Vector of editmode items */
+	int8_t repeat_step;					/**< Step of the autorepeat, 0 when stopped */
+	uint8_t repeats;					/**< Autorepeats at the current period */
+	uint16_t repeat_period;				/**< Autorepeat period in ms */
+	uint8_t repeat_btn;					/**< Button held for the autorepeat */
 } menu_editmode;
 
-/// The message bus
-static struct sys_messagebus *messagebus;
+/// Edit mode autorepeat timer
+static struct timer0_swtimer editmode_repeat_timer;
+
+/// The message bus node pool
+static struct sys_messagebus messagebus[SYS_MESSAGEBUS_NODES];
+
+/// Per message bit, a bitfield of the pool nodes listening to that message
+static uint16_t messagebus_listeners[16];
+
+#if SYS_MESSAGEBUS_NODES > 16
+#error "SYS_MESSAGEBUS_NODES cannot be higher than 16"
+#endif
+
+/// Ring buffer carrying messages from interrupts (producer) to the mainloop (consumer)
+static volatile struct sys_messagebus_event messagebus_ring[SYS_MESSAGEBUS_RING];
+
+/// Ring indexes, free running. Head is only written by interrupts, tail by the mainloop
+static volatile uint8_t messagebus_ring_head;
+static volatile uint8_t messagebus_ring_tail;
+
+/// Number of messages lost because the ring was full
+static volatile uint16_t messagebus_ring_overruns;
+
+/// Per message bit, occurrences and first timestamp of the messages being delivered
+static uint16_t messagebus_counts[16];
+static uint16_t messagebus_stamps[16];
+
+#if SYS_MESSAGEBUS_RING & (SYS_MESSAGEBUS_RING - 1) || SYS_MESSAGEBUS_RING > 128
+#error "SYS_MESSAGEBUS_RING must be a power of two, not higher than 128"
+#endif
+
+/// Deferred work queue, only changed with interrupts disabled
+static void (*workqueue[SYS_WORKQUEUE_SIZE])(void);
+static volatile uint8_t workqueue_head;
+static volatile uint8_t workqueue_tail;
+
+/// Number of drivers needing SMCLK while the mainloop sleeps
+static uint8_t smclk_users;
+
+#if SYS_WORKQUEUE_SIZE & (SYS_WORKQUEUE_SIZE - 1) || SYS_WORKQUEUE_SIZE > 128
+#error "SYS_WORKQUEUE_SIZE must be a power of two, not higher than 128"
+#endif
 
 
 // *************************************************************************************************
@@ -149,6 +183,37 @@ static struct sys_messagebus *messagebus;
 // *************************************************************************************************
 
 
+//* ************************************************************************************************
+/// @fn			messagebus_update_listeners
+/// @brief		Rebuild the listeners bitfield of each message for a pool node
+///				and arm the interrupt sources of the listened messages.
+/// @return		none
+//* ************************************************************************************************
+static void messagebus_update_listeners(uint8_t node)
+{
+	uint16_t listens = messagebus[node].listens;
+	uint16_t mask = 1u << node;
+	uint16_t *l = messagebus_listeners;
+	uint8_t i = 0;
+	
+	uint16_t listened = 0;
+	
+	for (; i < 16; i++, l++, listens >>= 1)
+	{
+		if (listens & 1)
+			*l |= mask;
+		else
+			*l &= ~mask;
+		
+		if (*l)
+			listened |= 1u << i;
+	}
+	
+	// Only keep the interrupt sources someone is listening to
+	rtca_set_events(listened & 0x7f);
+	timer0_set_events((listened >> 7) & 0x07);
+}
+
 //* ************************************************************************************************
 /// @fn			sys_messagebus_register
 /// @brief		Register an event callback.
@@ -156,17 +221,34 @@ static struct sys_messagebus *messagebus;
 //* ************************************************************************************************
 void sys_messagebus_register(void (*callback)(enum sys_message), enum sys_message listens)
 {
-	struct sys_messagebus **p = &messagebus;
+	uint8_t node = SYS_MESSAGEBUS_NODES;
+	uint8_t i = 0;
 	
-	while (*p)
+	for (; i < SYS_MESSAGEBUS_NODES; i++)
 	{
-		p = &(*p)->next;
+		// Already registered, just extend what it listens to
+		if (messagebus[i].fn == callback)
+		{
+			node = i;
+			break;
+		}
+		
+		// Remember the first free node
+		if (!messagebus[i].fn && node == SYS_MESSAGEBUS_NODES)
+		{
+			node = i;
+			messagebus[i].listens = 0;
+		}
 	}
 	
-	*p = malloc(sizeof(struct sys_messagebus));
-	(*p)->next = NULL;
-	(*p)->fn = callback;
-	(*p)->listens = listens;
+	// Pool is exhausted
+	if (node == SYS_MESSAGEBUS_NODES)
+		return;
+	
+	messagebus[node].fn = callback;
+	messagebus[node].listens |= listens;
+	
+	messagebus_update_listeners(node);
 }
 
 //* ************************************************************************************************
@@ -176,60 +258,148 @@ void sys_messagebus_register(void (*callback)(enum sys_message), enum sys_messag
 //* ************************************************************************************************
 void sys_messagebus_unregister(void (*callback)(enum sys_message))
 {
-	struct sys_messagebus *p = messagebus, *pp = NULL;
+	uint8_t i = 0;
 	
-	while (p)
+	for (; i < SYS_MESSAGEBUS_NODES; i++)
 	{
-		if (p->fn == callback)
+		if (messagebus[i].fn == callback)
 		{
-			if (!pp)
-				messagebus = p->next;
-			else
-				pp->next = p->next;
+			messagebus[i].fn = NULL;
+			messagebus[i].listens = 0;
 			
-			free(p);
+			messagebus_update_listeners(i);
 		}
-		
-		pp = p;
-		p = p->next;
 	}
 }
 
 //* ************************************************************************************************
-/// @fn			check_events(void)
-/// @brief		Check for events and notify the listener.
+/// @fn			sys_messagebus_post
+/// @brief		Queue messages from interrupt context.
 /// @return		none
 //* ************************************************************************************************
-void check_events(void)
+void sys_messagebus_post(enum sys_message msg)
 {
-	enum sys_message msg = 0;
+	uint8_t head = messagebus_ring_head;
+	uint8_t pending = head - messagebus_ring_tail;
+	volatile struct sys_messagebus_event *e;
 	
-	// Event from : "drivers/rtca"
-	if (rtca_last_event)
+	// Merge into the newest entry, unless the mainloop may be reading it right now
+	if (pending > 1)
 	{
-		msg |= rtca_last_event;
-		rtca_last_event = 0;
+		e = &messagebus_ring[(uint8_t)(head - 1) & (SYS_MESSAGEBUS_RING - 1)];
+		
+		if (e->msg == msg && e->count < 0xff)
+		{
+			e->count++;
+			return;
+		}
 	}
 	
-	// Event from : "drivers/timer"
-	if (timer0_last_event)
+	if (pending == SYS_MESSAGEBUS_RING)
 	{
-		msg |= timer0_last_event << 7;
-		timer0_last_event = 0;
+		messagebus_ring_overruns++;
+		return;
 	}
 	
-	// Event from : "drivers/accelerometer"
-	if(as_last_interrupt)
+	e = &messagebus_ring[head & (SYS_MESSAGEBUS_RING - 1)];
+	e->msg = msg;
+	e->count = 1;
+	e->stamp = TA0R;
+	
+	// Publish the entry only once it is complete
+	messagebus_ring_head = head + 1;
+}
+
+//* ************************************************************************************************
+/// @fn			messagebus_account
+/// @brief		Add occurrences of messages to the ones being delivered.
+/// @return		none
+//* ************************************************************************************************
+static void messagebus_account(uint16_t bits, uint8_t count, uint16_t stamp)
+{
+	uint8_t i = 0;
+	
+	for (; bits; bits >>= 1, i++)
 	{
-		msg |= SYS_MSG_AS_INT;
-		as_last_interrupt = 0;
+		if (!(bits & 1))
+			continue;
+		
+		if (!messagebus_counts[i])
+			messagebus_stamps[i] = stamp;
+		
+		messagebus_counts[i] += count;
 	}
+}
+
+//* ************************************************************************************************
+/// @fn			messagebus_bit
+/// @brief		Index of the lowest bit set in a message.
+/// @return		bit index, 16 if none
+//* ************************************************************************************************
+static uint8_t messagebus_bit(uint16_t msg)
+{
+	uint8_t i = 0;
+	
+	for (; i < 16 && !(msg & 1); i++)
+		msg >>= 1;
+	
+	return i;
+}
+
+//* ************************************************************************************************
+/// @fn			sys_messagebus_count
+/// @brief		Occurrences of a message being delivered.
+/// @return		number of occurrences
+//* ************************************************************************************************
+uint16_t sys_messagebus_count(enum sys_message msg)
+{
+	uint8_t i = messagebus_bit(msg);
+	
+	return (i < 16 ? messagebus_counts[i] : 0);
+}
+
+//* ************************************************************************************************
+/// @fn			sys_messagebus_stamp
+/// @brief		Timestamp of the first occurrence of a message being delivered.
+/// @return		TA0R value
+//* ************************************************************************************************
+uint16_t sys_messagebus_stamp(enum sys_message msg)
+{
+	uint8_t i = messagebus_bit(msg);
 	
-	// Event from : "driver/pressure"
-	if(ps_last_interrupt)
+	return (i < 16 ? messagebus_stamps[i] : 0);
+}
+
+//* ************************************************************************************************
+/// @fn			sys_messagebus_overruns
+/// @brief		Number of messages lost because the ring was full.
+/// @return		overrun counter
+//* ************************************************************************************************
+uint16_t sys_messagebus_overruns(void)
+{
+	return messagebus_ring_overruns;
+}
+
+//* ************************************************************************************************
+/// @fn			check_events(void)
+/// @brief		Check for events and notify the listener.
+/// @return		none
+//* ************************************************************************************************
+void check_events(void)
+{
+	enum sys_message msg = 0;
+	uint8_t tail = messagebus_ring_tail;
+	
+	// Events from : "drivers/rtca", "drivers/timer", "drivers/accelerometer", "driver/pressure"
+	while (tail != messagebus_ring_head)
 	{
-		msg |= SYS_MSG_PS_INT;
-		ps_last_interrupt = 0;
+		struct sys_messagebus_event e = messagebus_ring[tail & (SYS_MESSAGEBUS_RING - 1)];
+		
+		// Hand the entry back to the producer only after copying it
+		messagebus_ring_tail = ++tail;
+		
+		msg |= e.msg;
+		messagebus_account(e.msg, e.count, e.stamp);
 	}
 	
 #ifdef CONFIG_BATTERY_MONITOR
@@ -238,26 +408,122 @@ void check_events(void)
 	if ((msg & SYS_MSG_RTC_MINUTE) == SYS_MSG_RTC_MINUTE)
 	{
 		msg |= SYS_MSG_BATT;
+		messagebus_account(SYS_MSG_BATT, 1, sys_messagebus_stamp(SYS_MSG_RTC_MINUTE));
 		battery_measurement();
 	}
 	
 #endif
 	
+	if (msg)
+		TRACE(TRACE_EVENTS, msg);
+	
 	{
 		struct sys_messagebus *p = messagebus;
+		uint16_t *l = messagebus_listeners;
+		uint16_t bits = msg;
+		uint16_t nodes = 0;
 		
-		while (p)
+		// Only look at the listeners of the messages that are set
+		for (; bits; bits >>= 1, l++)
 		{
-			// Notify listener if he registered for any of these messages
-			if (msg & p->listens)
+			if (bits & 1)
+				nodes |= *l;
+		}
+		
+		// Notify each listener once, even if he registered for several of these messages
+		for (; nodes; nodes >>= 1, p++)
+		{
+			// A previous callback may have unregistered this node
+			if ((nodes & 1) && p->fn)
 			{
+				STACK_SCOPE(p->fn);
+				PROF_SCOPE(p->fn);
 				p->fn(msg);
 			}
-			
-			// Move to next
-			p = p->next;
 		}
 	}
+	
+	// Wake up the threads waiting for these messages
+	pt_deliver(msg);
+	
+	// Occurrences were delivered, start counting again
+	{
+		uint16_t *c = messagebus_counts;
+		uint16_t bits = msg;
+		
+		for (; bits; bits >>= 1, c++)
+			*c = 0;
+	}
+}
+
+
+//* ************************************************************************************************
+/// @fn			sys_workqueue_add
+/// @brief		Queue work for the mainloop.
+/// @return		none
+//* ************************************************************************************************
+void sys_workqueue_add(void (*fn)(void))
+{
+	uint16_t sr = __read_status_register();
+	uint8_t i;
+	
+	__dint();
+	
+	// Already waiting, it will see the latest state when it runs
+	for (i = workqueue_tail; i != workqueue_head; i++)
+	{
+		if (workqueue[i & (SYS_WORKQUEUE_SIZE - 1)] == fn)
+			goto out;
+	}
+	
+	if ((uint8_t)(workqueue_head - workqueue_tail) < SYS_WORKQUEUE_SIZE)
+		workqueue[workqueue_head++ & (SYS_WORKQUEUE_SIZE - 1)] = fn;
+	
+out:
+	__write_status_register(sr);
+}
+
+//* ************************************************************************************************
+/// @fn			sys_smclk_keep
+/// @brief		Count the drivers needing SMCLK in low power mode.
+/// @return		none
+//* ************************************************************************************************
+void sys_smclk_keep(uint8_t keep)
+{
+	if (keep)
+		smclk_users++;
+	else if (smclk_users)
+		smclk_users--;
+}
+
+//* ************************************************************************************************
+/// @fn			check_work(void)
+/// @brief		Run the deferred work, including work queued meanwhile.
+/// @return		none
+//* ************************************************************************************************
+static void check_work(void)
+{
+	void (*fn)(void);
+	
+	while (1)
+	{
+		__disable_interrupt();
+		
+		if (workqueue_tail == workqueue_head)
+			break;
+		
+		fn = workqueue[workqueue_tail++ & (SYS_WORKQUEUE_SIZE - 1)];
+		
+		__enable_interrupt();
+		
+		{
+			STACK_SCOPE(fn);
+			PROF_SCOPE(fn);
+			fn();
+		}
+	}
+	
+	__enable_interrupt();
 }
 
 
@@ -266,6 +532,79 @@ void check_events(void)
 // *************************************************************************************************
 
 
+//* ************************************************************************************************
+/// @fn			editmode_repeat_stop(void)
+/// @brief		Stop the autorepeat of UP/DOWN.
+/// @return		none
+//* ************************************************************************************************
+static void editmode_repeat_stop(void)
+{
+	menu_editmode.repeat_step = 0;
+	timer0_swtimer_stop(&editmode_repeat_timer);
+}
+
+//* ************************************************************************************************
+/// @fn			editmode_repeat(void)
+/// @brief		Apply the held UP/DOWN again, faster and faster.
+/// @return		none
+//* ************************************************************************************************
+static void editmode_repeat(void)
+{
+	// Edit mode was left, or another button was pressed meanwhile
+	if (!menu_editmode.enabled || !menu_editmode.repeat_step)
+		return;
+	
+	menu_editmode.items[menu_editmode.pos].set(menu_editmode.repeat_step);
+	
+	if (++menu_editmode.repeats == EDITMODE_REPEAT_ACCEL)
+	{
+		menu_editmode.repeats = 0;
+		
+		if (menu_editmode.repeat_period > EDITMODE_REPEAT_MIN)
+			menu_editmode.repeat_period >>= 1;
+		// Held at the fastest period, make bigger steps
+		else if (menu_editmode.repeat_step == 1 || menu_editmode.repeat_step == -1)
+			menu_editmode.repeat_step *= EDITMODE_REPEAT_FAST;
+	}
+	
+	timer0_swtimer_start(&editmode_repeat_timer, menu_editmode.repeat_period, 0, 0);
+}
+
+//* ************************************************************************************************
+/// @fn			editmode_repeat_fn(void)
+/// @brief		Autorepeat timer callback, from interrupt context.
+/// @return		none
+//* ************************************************************************************************
+static void editmode_repeat_fn(void)
+{
+	// Stop once the button is released
+	if (ports_held_btns() & menu_editmode.repeat_btn)
+		sys_workqueue_add(&editmode_repeat);
+	else
+		menu_editmode.repeat_step = 0;
+}
+
+//* ************************************************************************************************
+/// @fn			editmode_repeat_start(int8_t step, uint8_t btn)
+/// @brief		Start the autorepeat of a held UP/DOWN.
+/// @return		none
+//* ************************************************************************************************
+static void editmode_repeat_start(int8_t step, uint8_t btn)
+{
+	menu_editmode.repeat_step = step;
+	menu_editmode.repeat_btn = btn;
+	menu_editmode.repeats = 0;
+	menu_editmode.repeat_period = EDITMODE_REPEAT_START;
+	
+	editmode_repeat_timer.fn = &editmode_repeat_fn;
+	editmode_repeat_timer.flags |= TIMER0_SWTIMER_WAKEUP;
+	
+	// The long press is the first step
+	menu_editmode.items[menu_editmode.pos].set(step);
+	
+	timer0_swtimer_start(&editmode_repeat_timer, menu_editmode.repeat_period, 0, 0);
+}
+
 //* ************************************************************************************************
 /// @fn			editmode_handler(void)
 /// @brief		Edit mode routine
@@ -273,6 +612,12 @@ void check_events(void)
 //* ************************************************************************************************
 static void editmode_handler(void)
 {
+	if (!ports_pressed_btns)
+		return;
+	
+	// Any button ends the autorepeat
+	editmode_repeat_stop();
+	
 	// STAR button exits edit mode
 	if (BIT_IS_SET(ports_pressed_btns, PORTS_BTN_STAR))
 	{
@@ -297,14 +642,22 @@ static void editmode_handler(void)
 	// UP button increments by 1 the item's value
 	else if (BIT_IS_SET(ports_pressed_btns, PORTS_BTN_UP))
 	{
-		/// @todo Replace here to allow user defined increments
 		menu_editmode.items[menu_editmode.pos].set(1);
 	}
-	// UP button decrements by 1 the item's value
+	// DOWN button decrements by 1 the item's value
 	else if (BIT_IS_SET(ports_pressed_btns, PORTS_BTN_DOWN))
 	{
 		menu_editmode.items[menu_editmode.pos].set(-1);
 	}
+	// Holding UP or DOWN repeats it until released
+	else if (BIT_IS_SET(ports_pressed_btns, PORTS_BTN_LUP))
+	{
+		editmode_repeat_start(1, PORTS_BTN_UP);
+	}
+	else if (BIT_IS_SET(ports_pressed_btns, PORTS_BTN_LDOWN))
+	{
+		editmode_repeat_start(-1, PORTS_BTN_DOWN);
+	}
 }
 
 //* ************************************************************************************************
@@ -332,21 +685,23 @@ static void menumode_handler(void)
 		display_chars(0, LCD_SEG_L2_4_0, NULL, BLINK_OFF);
 		
 		// Activate item
-		if (menumode.item->activate_fn)
-			menumode.item->activate_fn();
+		if (MENU_ITEM->activate_fn)
+			MENU_ITEM->activate_fn();
 		
 	}
 	// UP button selects/shows the next item
 	else if (BIT_IS_SET(ports_pressed_btns, PORTS_BTN_UP))
 	{
-		menumode.item = menumode.item->next;
-		display_chars(0, LCD_SEG_L2_4_0, menumode.item->name, SEG_SET);
+		if (++menumode.item == menu_table_size)
+			menumode.item = 0;
+		display_chars(0, LCD_SEG_L2_4_0, MENU_ITEM->name, SEG_SET);
 	}
 	// UP button selects/shows the previous item
 	else if (BIT_IS_SET(ports_pressed_btns, PORTS_BTN_DOWN))
 	{
-		menumode.item = menumode.item->prev;
-		display_chars(0, LCD_SEG_L2_4_0, menumode.item->name, SEG_SET);
+		if (menumode.item-- == 0)
+			menumode.item = menu_table_size - 1;
+		display_chars(0, LCD_SEG_L2_4_0, MENU_ITEM->name, SEG_SET);
 	}
 }
 
@@ -358,8 +713,8 @@ static void menumode_handler(void)
 static void menumode_enable(void)
 {
 	// Deactivate current menu item
-	if (menumode.item->deactivate_fn)
-		menumode.item->deactivate_fn();
+	if (MENU_ITEM->deactivate_fn)
+		MENU_ITEM->deactivate_fn();
 	
 	// Enable edit mode
 	menumode.enabled = 1;
@@ -373,7 +728,7 @@ static void menumode_enable(void)
 	
 	// Show up blinking name of current selected item
 	display_chars(0, LCD_SEG_L2_4_0, NULL, BLINK_ON);
-	display_chars(0, LCD_SEG_L2_4_0, menumode.item->name, SEG_SET);
+	display_chars(0, LCD_SEG_L2_4_0, MENU_ITEM->name, SEG_SET);
 }
 
 //* ************************************************************************************************
@@ -383,6 +738,11 @@ static void menumode_enable(void)
 //* ************************************************************************************************
 static void check_buttons(void)
 {
+	STACK_SCOPE(check_buttons);
+	
+	if (ports_pressed_btns)
+		TRACE(TRACE_BUTTONS, ports_pressed_btns);
+	
 	// We are in edit mode, call it's handler routine
 	if (menu_editmode.enabled)
 	{
@@ -399,8 +759,8 @@ static void check_buttons(void)
 		// (long) STAR button
 		if (BIT_IS_SET(ports_pressed_btns, PORTS_BTN_LSTAR))
 		{
-			if (menumode.item->lstar_btn_fn)
-				menumode.item->lstar_btn_fn();
+			if (MENU_ITEM->lstar_btn_fn)
+				MENU_ITEM->lstar_btn_fn();
 		}
 		// STAR button
 		else if (BIT_IS_SET(ports_pressed_btns, PORTS_BTN_STAR))
@@ -411,89 +771,38 @@ static void check_buttons(void)
 		// (long) NUM button
 		else if (BIT_IS_SET(ports_pressed_btns, PORTS_BTN_LNUM))
 		{
-			if (menumode.item->lnum_btn_fn)
-				menumode.item->lnum_btn_fn();
+			if (MENU_ITEM->lnum_btn_fn)
+				MENU_ITEM->lnum_btn_fn();
 		}
 		// NUM button
 		else if (BIT_IS_SET(ports_pressed_btns, PORTS_BTN_NUM))
 		{
-			if (menumode.item->num_btn_fn)
-				menumode.item->num_btn_fn();
+			if (MENU_ITEM->num_btn_fn)
+				MENU_ITEM->num_btn_fn();
 		}
 		// UP & DOWN buttons
 		else if (BIT_IS_SET(ports_pressed_btns, PORTS_BTN_UP | PORTS_BTN_DOWN))
 		{
-			if (menumode.item->updown_btn_fn)
-				menumode.item->updown_btn_fn();
+			if (MENU_ITEM->updown_btn_fn)
+				MENU_ITEM->updown_btn_fn();
 		}
 		// UP button
 		else if (BIT_IS_SET(ports_pressed_btns, PORTS_BTN_UP))
 		{
-			if (menumode.item->up_btn_fn)
-				menumode.item->up_btn_fn();
+			if (MENU_ITEM->up_btn_fn)
+				MENU_ITEM->up_btn_fn();
 		}
 		// DOWN button
 		else if (BIT_IS_SET(ports_pressed_btns, PORTS_BTN_DOWN))
 		{
-			if (menumode.item->down_btn_fn)
-				menumode.item->down_btn_fn();
+			if (MENU_ITEM->down_btn_fn)
+				MENU_ITEM->down_btn_fn();
 		}
 	}
 	
 	ports_pressed_btns = 0;
 }
 
-//* ************************************************************************************************
-/// @fn			menu_add_entry
-/// @brief		Add an entry to the menu
-/// @return		none
-//* ************************************************************************************************
-void menu_add_entry(char const * name,
-	void (*up_btn_fn)(void),
-	void (*down_btn_fn)(void),
-	void (*num_btn_fn)(void),
-	void (*lstar_btn_fn)(void),
-	void (*lnum_btn_fn)(void),
-	void (*updown_btn_fn)(void),
-	void (*activate_fn)(void),
-	void (*deactivate_fn)(void))
-{
-	struct menu **menu_hd = &menu_head;
-	struct menu *menu_p;
-
-	if (! *menu_hd)
-	{
-		// Head is empty, create new menu item linked to itself
-		menu_p = (struct menu *) malloc(sizeof(struct menu));
-		menu_p->next = menu_p;
-		menu_p->prev = menu_p;
-		*menu_hd = menu_p;
-		
-		// There wasnt any menu active, so we activate this one
-		menumode.item = menu_p;
-		activate_fn();
-	}
-	else
-	{
-		// Insert new item before head
-		menu_p = (struct menu *) malloc(sizeof(struct menu));
-		menu_p->next = (*menu_hd);
-		menu_p->prev = (*menu_hd)->prev;
-		(*menu_hd)->prev = menu_p;
-		menu_p->prev->next = menu_p;
-	}
-	
-	menu_p->name = name;
-	menu_p->up_btn_fn = up_btn_fn;
-	menu_p->down_btn_fn = down_btn_fn;
-	menu_p->num_btn_fn = num_btn_fn;
-	menu_p->lstar_btn_fn = lstar_btn_fn;
-	menu_p->lnum_btn_fn = lnum_btn_fn;
-	menu_p->updown_btn_fn = updown_btn_fn;
-	menu_p->activate_fn = activate_fn;
-	menu_p->deactivate_fn = deactivate_fn;
-}
-
 //* ************************************************************************************************
 /// @fn			menu_editmode_start
 /// @brief		Start the edit mode
@@ -530,13 +839,18 @@ void init_application(void)
 	// ---------------------------------------------------------------------
 	// Enable watchdog
 	
-	// Watchdog triggers after 16 seconds when not cleared
+	// Watchdog triggers after 256 seconds when not cleared
 #ifdef USE_WATCHDOG
-	WDTCTL = WDTPW + WDTIS__512K + WDTSSEL__ACLK;
+	WDTCTL = WDTPW + SYS_WATCHDOG_INTERVAL + WDTSSEL__ACLK;
 #else
 	WDTCTL = WDTPW + WDTHOLD;
 #endif
 	
+#ifdef CONFIG_STACK_MONITOR
+	// Paint the free RAM to find the deepest stack use later on
+	stack_paint();
+#endif
+	
 	// ---------------------------------------------------------------------
 	// Configure PMM
 	
@@ -661,6 +975,11 @@ void init_application(void)
 	// Init buzzer
 	buzzer_init();
 	
+#ifdef CONFIG_PROFILE
+	// TA1 is taken from the buzzer to measure time
+	prof_init();
+#endif
+	
 	// ---------------------------------------------------------------------
 	// Init pressure sensor
 	
@@ -677,12 +996,17 @@ void init_application(void)
 	// From: "drivers/temperature"
 	temperature_init();
 	
-	/// @todo What is this ?
+	// From: "drivers/infomem", format the settings storage on first boot
 #ifdef CONFIG_INFOMEM
 	
 	if (infomem_ready() == -2)
 		infomem_init(INFOMEM_C, INFOMEM_C + 2 * INFOMEM_SEGMENT_SIZE);
 	
+#endif
+	
+	// From: "core/alarms", needs the time and the settings storage
+#ifdef CONFIG_RTC_IRQ
+	alarms_init();
 #endif
 
 }
@@ -720,12 +1044,40 @@ int main(void)
 	// Init modules
 	mod_init();
 	
+	// Activate the first menu item
+	if (MENU_ITEM->activate_fn)
+		MENU_ITEM->activate_fn();
+	
 	// Main loop
 	while (1)
 	{
-		// Go to LPM3, wait for interrupts
-		_BIS_SR(LPM3_bits + GIE);
-		__no_operation();
+		// Show what was drawn since the last iteration
+		display_commit();
+		
+		// Go to LPM3, wait for interrupts. Interrupts are disabled while looking for
+		// pending messages, work or buttons so that no wakeup gets lost in between
+		__disable_interrupt();
+		
+		if (messagebus_ring_head != messagebus_ring_tail
+			|| workqueue_head != workqueue_tail || ports_pressed_btns || pt_pending())
+			__enable_interrupt();
+		else
+		{
+#ifdef CONFIG_WAKE_STATS
+			wake_stat_sleep();
+#endif
+			
+			if (smclk_users)
+				_BIS_SR(LPM1_bits + GIE);
+			else
+				_BIS_SR(LPM3_bits + GIE);
+			
+			__no_operation();
+			
+#ifdef CONFIG_WAKE_STATS
+			wake_stat_wakeup();
+#endif
+		}
 		
 		// Service watchdog on wakeup
 		#ifdef USE_WATCHDOG
@@ -736,6 +1088,12 @@ int main(void)
 		// Check if any driver has events pending
 		check_events();
 		
+		// Run the work deferred by interrupts and listeners
+		check_work();
+		
+		// Let the threads continue
+		pt_run();
+		
 		// Check for button presses, drive the menu
 		check_buttons();
 	}
@@ -753,33 +1111,15 @@ int main(void)
 //* ************************************************************************************************
 void helpers_loop(uint8_t *value, uint8_t lower, uint8_t upper, int8_t step)
 {
-	// For now only increase/decrease on steps of 1 value
-	if (step > 0)
-	{
-		// Prevent overflow
-		if (*value == 255)
-		{
-			*value = lower;
-			return;
-		}
-		
-		(*value)++;
-		
-		if(*value -1 == upper)
-			*value = lower;
-	}
-	else
-	{
-		// Prevent overflow
-		if (*value == 0)
-		{
-			*value = upper;
-			return;
-		}
-		
-		(*value)--;
-		
-		if(*value +1 == lower)
-			*value = upper;
-	}
+	int16_t range = (int16_t)upper - lower + 1;
+	int16_t v = (int16_t)*value - lower + step;
+	
+	// Wrap around as many times as needed, out of range values come back in the interval
+	while (v < 0)
+		v += range;
+	
+	while (v >= range)
+		v -= range;
+	
+	*value = lower + v;
 }
@@ -39,11 +39,34 @@
 // *************************************************************************************************
 // Global Variable section
 
+//* ************************************************************************************************
+/// @brief		A main menu entry.
+///
+/// @details	Each module defines its entry as a constant named mod_<module>_menu, so that it
+/// 			stays in flash. tools/config/make_modinit.py puts the entries of the enabled
+/// 			modules in #menu_table, in the order of their initialization.
+/// @note		All fields except <i>name</i> can be left NULL if you don't need their
+/// 			functionality.
+/// @note		The <i>name</i> string cannot be longer than 5 characters due to the LCD screen size.
+//* ************************************************************************************************
+struct menu
+{
+	char const * name;			/**< Item name to be displayed in the menu */
+	void (*up_btn_fn)(void);	/**< Callback for up button presses. */
+	void (*down_btn_fn)(void);	/**< Callback for down button presses. */
+	void (*num_btn_fn)(void);	/**< Callback for num button presses. */
+	void (*lstar_btn_fn)(void);	/**< Callback for long star button presses. */
+	void (*lnum_btn_fn)(void);	/**< Callback for long num button presses. */
+	void (*updown_btn_fn)(void);/**< Callback for up&down button presses. */
+	void (*activate_fn)(void);	/**< Callback for when the user switches into this entry in the menu. */
+	void (*deactivate_fn)(void);/**< Callback for when the user switches out from this entry in the menu. */
+};
+
 ///	A item structure for menu_editmode_start.
 struct menu_editmode_item {
 	void (* select)(void);     /**< item selected callback */
 	void (* deselect)(void);   /**< item deselected callback */
-	void (* set)(int8_t step); /**< set value of item callback */
+	void (* set)(int8_t step); /**< set value of item callback, step is 1 or -1 for a press, bigger while UP/DOWN is held */
 };
 
 ///	Handy prototype typedef for helpers_loop() function.
@@ -75,47 +98,56 @@ enum sys_message
 	SYS_MSG_AS_INT 		= BITA, /**<  Accelerometer event from the hardware Accel sensor. */
 	SYS_MSG_PS_INT		= BITB,	/**<  Pressure event from the hardware Pressure sensor. */
 	SYS_MSG_BATT		= BITC, /**<  Battery event from the hardware Voltage sensor. */
+	
+	// Core/alarms
+	SYS_MSG_ALARM		= BITD, /**<  An alarm of the table rang, see alarms_fired(). */
+};
+
+/// Maximum number of nodes that can be registered in the message bus at the same time.
+/// @note	Nodes are tracked as bits of an uint16_t, this value cannot be higher than 16.
+#define SYS_MESSAGEBUS_NODES	16
+
+/// Number of entries in the ring buffer carrying messages from interrupts to the mainloop.
+/// @note	Must be a power of two. Repeated messages are merged into a single entry,
+/// 		so the ring only fills up if many different messages arrive while the mainloop is busy.
+#define SYS_MESSAGEBUS_RING	8
+
+/// Watchdog interval (256s at ACLK).
+/// @note	The mainloop only services the watchdog when it wakes up, and with no
+/// 		listeners it may sleep until the next RTC minute event.
+#define SYS_WATCHDOG_INTERVAL	WDTIS__8192K
+
+/// An entry of the ring buffer carrying messages from interrupts to the mainloop.
+struct sys_messagebus_event
+{
+	/// Messages posted by the interrupt
+	enum sys_message msg;
+	
+	/// Number of times the same messages were posted before being delivered
+	uint8_t count;
+	
+	/// Value of TA0R (1/16384s units) when the messages were first posted
+	uint16_t stamp;
 };
 
-/// Linked list of nodes listening to the message bus.
+/// Maximum number of work items waiting in the deferred work queue.
+/// @note	Must be a power of two.
+#define SYS_WORKQUEUE_SIZE	4
+
+/// A node listening to the message bus, nodes live in a fixed size pool.
 struct sys_messagebus
 {
-	/// Callback for receiving messages from the system bus
+	/// Callback for receiving messages from the system bus, NULL if the node is free
 	void (*fn)(enum sys_message);
 	
 	/// Bitfield of message types that the node wishes to receive
 	enum sys_message listens;
-	
-	/// Pointer to the next node in the list
-	struct sys_messagebus *next;
 };
 
 
 // *************************************************************************************************
 // Prototypes section
 
-//* ************************************************************************************************
-/// @brief		Adds an entry to the main menu.
-/// 
-/// @details	This function is to be used by modules, so that they can be
-/// 			visible in the main menu. A good place to call this function is from the 
-/// 			corresponding module's _init function.
-/// @note		This function is NULL safe. You can set all of its parameters to NULL (except name)
-/// 			if you don't need their functionality.
-/// @note		The <i>name</i> string cannot be longer than 5 characters due to the LCD screen size.
-//* ************************************************************************************************
-void menu_add_entry(
-	char const * name,			/**< Item name to be displayed in the menu */
-	void (*up_btn_fn)(void),	/**< Callback for up button presses. */
-	void (*down_btn_fn)(void),	/**< Callback for down button presses. */
-	void (*num_btn_fn)(void),	/**< Callback for num button presses. */
-	void (*lstar_btn_fn)(void),	/**< Callback for long star button presses. */
-	void (*lnum_btn_fn)(void),	/**< Callback for long num button presses. */
-	void (*updown_btn_fn)(void),/**< Callback for up&down button presses. */
-	void (*activate_fn)(void),	/**< Callback for when the user switches into this entry in the menu. */
-	void (*deactivate_fn)(void)	/**< Callback for when the user switches out from this entry in the menu. */
-);
-
 //* ************************************************************************************************
 /// @brief		Enters edit mode.
 /// 
@@ -123,7 +155,9 @@ void menu_add_entry(
 /// 			in the screen. For example, if a clock alarm is being displayed, then edit mode
 /// 			can be used to increase/decrease the values of hours and minutes.
 /// 			A good place to call this function is from the module's lstar_btn_fn function
-/// 			(see menu_add_entry()).<br />See modules/alarm.c for an example how to use this.
+/// 			(see struct menu).<br />See modules/alarm.c for an example how to use this.<br />
+/// 			Holding UP or DOWN repeats it, faster and faster and then with bigger steps,
+/// 			until the button is released.
 //* ************************************************************************************************
 void menu_editmode_start(
 	/// Callback for when the user exits from the edit mode.
@@ -136,18 +170,18 @@ void menu_editmode_start(
 unsigned short __even_in_range(unsigned short __value, unsigned short __bound);
 
 //* ************************************************************************************************
-/// @brief		Increment/decrements value by one without exiting the [lower, upper] interval.
+/// @brief		Increment/decrements value by step without exiting the [lower, upper] interval.
 /// 
-/// @details	If the value meets the upper bound, it is restarted from lower bound.
-/// 			If the value meets the lower bound, it is restarded from the upper bound.<br />
-/// @note		For now, only steps of -1 and 1 are considered.
+/// @details	If the value goes past the upper bound, it continues from the lower bound.
+/// 			If the value goes past the lower bound, it continues from the upper bound.<br />
+/// 			Steps bigger than the interval wrap around several times.
 /// @see		menu_editmode_start
 //* ************************************************************************************************
 void helpers_loop(
 	uint8_t *value,	/**< Value a pointer to the variable to be incremented. */
 	uint8_t lower,	/**< Lower the lower bound for the loop interval. */
 	uint8_t upper,	/**< Upper the upper bound for the loop interval. */
-	int8_t step		/**< 1 for incrementing value, -1 for a decrement */
+	int8_t step		/**< Positive for incrementing value, negative for a decrement */
 );
 
 //* ************************************************************************************************
@@ -155,6 +189,10 @@ void helpers_loop(
 /// 
 /// @details	Registers (add) a node to the message bus. A node can filter
 /// 			what message(s) are to be received by setting the bitfield \b listens.
+/// 			Registering an already registered callback adds \b listens to the messages
+/// 			it already receives.
+/// @note	Nodes are taken from a pool of #SYS_MESSAGEBUS_NODES, no memory is allocated.
+/// 		If the pool is exhausted the callback is not registered.
 /// @see		sys_message, sys_messagebus, sys_messagebus_unregister
 //* ************************************************************************************************
 void sys_messagebus_register(
@@ -176,6 +214,83 @@ void sys_messagebus_unregister(
 	void (*callback)(enum sys_message)
 );
 
+//* ************************************************************************************************
+/// @brief	Posts messages to the message bus.
+/// 
+/// @details	Queues \b msg in a ring buffer, the messages are delivered to the listeners
+/// 			the next time the mainloop runs. If the same messages are posted again before
+/// 			being delivered, the occurrences are counted instead of being lost.
+/// @note	This function is meant to be called by drivers from interrupt context, or
+/// 		with interrupts disabled. From interrupt context, remember to exit the low
+/// 		power mode so that the mainloop can run.
+/// @see	sys_messagebus_count, sys_messagebus_stamp
+//* ************************************************************************************************
+void sys_messagebus_post(
+	
+	/// Messages to post, several can be ORed together if they happened at the same time
+	enum sys_message msg
+);
+
+//* ************************************************************************************************
+/// @brief	Returns how many times a message happened since the last delivery.
+/// 
+/// @details	For example, a listener of #SYS_MSG_TIMER_20HZ gets 3 if the mainloop was
+/// 			blocked for 150ms, so that it can account for every tick.
+/// @note	Only valid inside a message bus callback, for a message being delivered.
+//* ************************************************************************************************
+uint16_t sys_messagebus_count(
+	
+	/// A single message type
+	enum sys_message msg
+);
+
+//* ************************************************************************************************
+/// @brief	Returns the TA0R timestamp of the first occurrence of a message.
+/// 
+/// @details	The event-to-handler latency, in 1/16384s units, is TA0R minus this value.
+/// @note	Only valid inside a message bus callback, for a message being delivered.
+//* ************************************************************************************************
+uint16_t sys_messagebus_stamp(
+	
+	/// A single message type
+	enum sys_message msg
+);
+
+//* ************************************************************************************************
+/// @brief	Returns the number of messages lost because the ring buffer was full.
+/// @see	SYS_MESSAGEBUS_RING
+//* ************************************************************************************************
+uint16_t sys_messagebus_overruns(void);
+
+//* ************************************************************************************************
+/// @brief	Defers work to the mainloop.
+/// 
+/// @details	Queues \b fn to be called from the mainloop, after the pending messages are
+/// 			delivered. Interrupt routines use this to hand over heavy follow-up work
+/// 			and return immediately, so that other interrupts are not delayed.
+/// @note	Can be called from interrupt context or from the mainloop. A function already
+/// 		waiting in the queue is not queued twice. If the queue is full
+/// 		(see #SYS_WORKQUEUE_SIZE) the work is dropped.
+//* ************************************************************************************************
+void sys_workqueue_add(
+	
+	/// Function to be called from the mainloop
+	void (*fn)(void)
+);
+
+//* ************************************************************************************************
+/// @brief	Keeps SMCLK running while the mainloop sleeps.
+/// 
+/// @details	The mainloop sleeps in LPM3, which stops SMCLK. Drivers that need SMCLK in the
+/// 			background, like the buzzer, call this with 1 so that the mainloop sleeps in
+/// 			LPM1 instead, and with 0 when they are done. Requests are counted.
+//* ************************************************************************************************
+void sys_smclk_keep(
+	
+	/// 1 to request SMCLK, 0 to release a previous request
+	uint8_t keep
+);
+
 
 #endif /* __EZCHRONOS_H__ */
 
@@ -210,8 +325,8 @@ void sys_messagebus_unregister(
 		</li>
 		
 		<li>
-			Then have a look to menu_add_entry(), this is what you should call during
-			module initialization to make it appear in the system menu. It is also in this function
+			Then have a look to struct menu, this is what your module defines as
+			mod_<module>_menu to make it appear in the system menu. It is also in this structure
 			where you specify the module functions that are to be called
 			when the user presses the ez430 chronos buttons.
 		</li>
@@ -227,6 +342,12 @@ void sys_messagebus_unregister(
 			sys_messagebus_register() and #sys_message, on how to make your module listen
 			for system events, like 1Hz events from the hardware timer.
 		</li>
+		
+		<li>
+			If your module has to wait for something, do not block in timer0_delay().
+			Have a look to core/pt.h instead, a thread can wait with PT_WAIT_MS()
+			or PT_WAIT_MSG() while the rest of the system keeps running.
+		</li>
 	</ol>
 	
 */
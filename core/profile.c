@@ -0,0 +1,150 @@
+/**
+	@file	profile.c
+	@brief	CPU time profiler
+
+	@see		http://www.openchronos-ng.sourceforge.net
+	@copyright
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+
+// *************************************************************************************************
+// Include section
+
+#include <core/profile.h>
+
+#ifdef CONFIG_PROFILE
+
+
+// *************************************************************************************************
+// Global Variable section
+
+struct prof_entry prof_table[PROF_ENTRIES];
+
+/// High word of the free running counter
+static volatile uint16_t prof_overflows;
+
+
+// *************************************************************************************************
+// Functions section
+
+//* ************************************************************************************************
+/// @fn			prof_init
+/// @brief		Run TA1 from SMCLK, continuous mode, counting overflows.
+/// @return		none
+//* ************************************************************************************************
+void prof_init(void)
+{
+	TA1CTL = TASSEL__SMCLK | MC__CONTINOUS | TACLR | TAIE;
+}
+
+//* ************************************************************************************************
+/// @fn			prof_now
+/// @brief		Read the 32bit free running counter.
+/// @return		SMCLK cycles
+//* ************************************************************************************************
+uint32_t prof_now(void)
+{
+	uint16_t sr = __read_status_register();
+	uint16_t hi, lo;
+
+	__dint();
+
+	hi = prof_overflows;
+	lo = TA1R;
+
+	// Overflow not serviced yet, either because we are in an interrupt or it just happened
+	if ((TA1CTL & TAIFG) && lo < 0x8000)
+		hi++;
+
+	__write_status_register(sr);
+
+	return ((uint32_t)hi << 16) | lo;
+}
+
+//* ************************************************************************************************
+/// @fn			prof_leave
+/// @brief		Account a measurement to its function.
+/// @return		none
+//* ************************************************************************************************
+void prof_leave(struct prof_mark *mark)
+{
+	uint32_t cycles = prof_now() - mark->start;
+	uint16_t sr = __read_status_register();
+	struct prof_entry *e = prof_table;
+
+	__dint();
+
+	for (; e < prof_table + PROF_ENTRIES; e++)
+	{
+		if (e->fn == mark->fn || !e->fn)
+			break;
+	}
+
+	// Table full, the function is ignored
+	if (e == prof_table + PROF_ENTRIES)
+		goto out;
+
+	e->fn = mark->fn;
+	e->total += cycles;
+
+	if (e->calls != 0xffff)
+		e->calls++;
+
+	if (cycles > e->worst)
+		e->worst = cycles;
+
+out:
+	__write_status_register(sr);
+}
+
+//* ************************************************************************************************
+/// @fn			prof_reset
+/// @brief		Clear the table.
+/// @return		none
+//* ************************************************************************************************
+void prof_reset(void)
+{
+	uint16_t sr = __read_status_register();
+	struct prof_entry *e = prof_table;
+
+	__dint();
+
+	for (; e < prof_table + PROF_ENTRIES; e++)
+	{
+		e->fn = NULL;
+		e->total = 0;
+		e->calls = 0;
+		e->worst = 0;
+	}
+
+	__write_status_register(sr);
+}
+
+//* ************************************************************************************************
+/// @fn			prof_TA1_ISR
+/// @brief		Count overflows of the free running counter.
+/// @return		none
+//* ************************************************************************************************
+__attribute__((interrupt(TIMER1_A1_VECTOR)))
+void prof_TA1_ISR(void)
+{
+	// Reading TA1IV clears the flag
+	if (TA1IV == TA1IV_TA1IFG)
+		prof_overflows++;
+}
+
+#endif /* CONFIG_PROFILE */
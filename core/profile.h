@@ -0,0 +1,109 @@
+/**
+	@file	profile.h
+	@brief	CPU time profiler
+
+	@see		http://www.openchronos-ng.sourceforge.net
+	@copyright
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	@details	When CONFIG_PROFILE is set, the time spent in each interrupt routine,
+				message bus listener, deferred work and thread is measured in SMCLK cycles,
+				using TA1 as a free running counter. The results are kept in #prof_table,
+				shown by the PROF module, and can be read with mspdebug:
+	@code
+	mspdebug rf2500 "sym find prof_table" "md prof_table 192"
+	@endcode
+				Each entry is 12 bytes: function address (2), total cycles (4), calls (2)
+				and worst case cycles (4), little endian. Match the addresses against the
+				symbols of openchronos.elf (msp430-nm).
+	@note		TA1 is also used by the buzzer, which is muted in profiling builds.
+				Times include the interrupts that happened meanwhile.
+ */
+
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+// *************************************************************************************************
+// Include section
+
+#include <core/openchronos.h>
+
+
+// *************************************************************************************************
+// Defines section
+
+/// Number of functions that can be profiled, the others are ignored
+#define PROF_ENTRIES	16
+
+#ifdef CONFIG_PROFILE
+
+//* ************************************************************************************************
+/// @brief	Accounts the time until the end of the enclosing scope to \b fn.
+/// @details	Put it at the very beginning of an interrupt routine, or in a block around a
+/// 			call. The time is accounted whatever way the scope is left (return, goto).
+//* ************************************************************************************************
+#define PROF_SCOPE(fn)	\
+	struct prof_mark __prof_mark __attribute__((cleanup(prof_leave))) = { (void *)(fn), prof_now() }
+
+#else
+
+#define PROF_SCOPE(fn)
+
+#endif /* CONFIG_PROFILE */
+
+
+// *************************************************************************************************
+// Global Variable section
+
+///	Profiling results of a function.
+struct prof_entry
+{
+	void *fn;			/**< Interrupt routine or callback address, NULL if the entry is free */
+	uint32_t total;		/**< Total SMCLK cycles spent */
+	uint16_t calls;		/**< Number of calls, saturated */
+	uint32_t worst;		/**< Longest call in SMCLK cycles */
+};
+
+///	A running measurement, see PROF_SCOPE().
+struct prof_mark
+{
+	void *fn;			/**< Function being measured */
+	uint32_t start;		/**< Value of prof_now() when the measurement started */
+};
+
+#ifdef CONFIG_PROFILE
+
+/// The profiling results, in order of first call.
+extern struct prof_entry prof_table[PROF_ENTRIES];
+
+
+// *************************************************************************************************
+// Prototypes section
+
+/// Starts the free running counter, exclusive use by openchronos system.
+void prof_init(void);
+
+/// Returns the free running counter, in SMCLK cycles.
+uint32_t prof_now(void);
+
+/// Ends a measurement started by PROF_SCOPE().
+void prof_leave(struct prof_mark *mark);
+
+/// Clears the profiling results.
+void prof_reset(void);
+
+#endif /* CONFIG_PROFILE */
+
+#endif /* __PROFILE_H__ */
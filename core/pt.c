@@ -0,0 +1,183 @@
+/**
+	@file	pt.c
+	@brief	Stackless threads (protothreads) scheduler
+
+	@see		http://www.openchronos-ng.sourceforge.net
+	@copyright
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+
+// *************************************************************************************************
+// Include section
+
+#include <core/pt.h>
+#include <core/profile.h>
+#include <core/stackmon.h>
+
+
+// *************************************************************************************************
+// Global Variable section
+
+/// Threads known to the scheduler, stopped threads are unlinked by pt_run()
+static struct pt *pt_list;
+
+/// Set when the threads have to run, from interrupts too
+static volatile uint8_t pt_ready;
+
+
+// *************************************************************************************************
+// Functions section
+
+//* ************************************************************************************************
+/// @fn			pt_timer_fn
+/// @brief		Thread timer expired, called from interrupt context.
+/// @return		none
+//* ************************************************************************************************
+static void pt_timer_fn(void)
+{
+	pt_ready = 1;
+}
+
+//* ************************************************************************************************
+/// @fn			pt_start
+/// @brief		Start or restart a thread.
+/// @return		none
+//* ************************************************************************************************
+void pt_start(struct pt *pt, enum pt_state (*fn)(struct pt *))
+{
+	struct pt **p = &pt_list;
+
+	timer0_swtimer_stop(&pt->timer);
+
+	pt->fn = fn;
+	pt->lc = 0;
+	pt->waits = 0;
+	pt->got = 0;
+
+	// The timer wakes up the mainloop so that the thread can continue
+	pt->timer.fn = pt_timer_fn;
+	pt->timer.flags |= TIMER0_SWTIMER_WAKEUP;
+
+	// Appended, pt_run() may be unlinking the thread that started this one
+	if (!pt->linked)
+	{
+		while (*p)
+			p = &(*p)->next;
+
+		pt->next = NULL;
+		*p = pt;
+		pt->linked = 1;
+	}
+
+	pt_ready = 1;
+}
+
+//* ************************************************************************************************
+/// @fn			pt_stop
+/// @brief		Stop a thread.
+/// @return		none
+//* ************************************************************************************************
+void pt_stop(struct pt *pt)
+{
+	timer0_swtimer_stop(&pt->timer);
+
+	// Unlinked later, pt_run() may be walking the list right now
+	pt->fn = NULL;
+}
+
+//* ************************************************************************************************
+/// @fn			pt_running
+/// @brief		Check if a thread is running.
+/// @return		1 if running
+//* ************************************************************************************************
+uint8_t pt_running(struct pt *pt)
+{
+	return (pt->fn != NULL);
+}
+
+//* ************************************************************************************************
+/// @fn			pt_yield
+/// @brief		Run the threads again on the next mainloop iteration.
+/// @return		none
+//* ************************************************************************************************
+void pt_yield(void)
+{
+	pt_ready = 1;
+}
+
+//* ************************************************************************************************
+/// @fn			pt_run
+/// @brief		Run each thread once.
+/// @return		none
+//* ************************************************************************************************
+void pt_run(void)
+{
+	struct pt **p = &pt_list;
+	struct pt *pt;
+
+	pt_ready = 0;
+
+	while ((pt = *p))
+	{
+		if (pt->fn)
+		{
+			STACK_SCOPE(pt->fn);
+			PROF_SCOPE(pt->fn);
+
+			if (pt->fn(pt) == PT_ENDED)
+				pt_stop(pt);
+		}
+
+		// The thread may have restarted itself
+		if (!pt->fn)
+		{
+			*p = pt->next;
+			pt->linked = 0;
+		}
+		else
+			p = &pt->next;
+	}
+}
+
+//* ************************************************************************************************
+/// @fn			pt_deliver
+/// @brief		Hand the delivered messages to the threads waiting for them.
+/// @return		none
+//* ************************************************************************************************
+void pt_deliver(enum sys_message msg)
+{
+	struct pt *pt = pt_list;
+
+	for (; pt; pt = pt->next)
+	{
+		if (pt->waits & msg)
+		{
+			pt->got |= pt->waits & msg;
+			pt_ready = 1;
+		}
+	}
+}
+
+//* ************************************************************************************************
+/// @fn			pt_pending
+/// @brief		Check if the threads have to run.
+/// @return		1 if they have to run
+//* ************************************************************************************************
+uint8_t pt_pending(void)
+{
+	return pt_ready;
+}
@@ -0,0 +1,163 @@
+/**
+	@file	pt.h
+	@brief	Stackless threads (protothreads)
+
+	@see		http://www.openchronos-ng.sourceforge.net
+	@copyright
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+#ifndef __PT_H__
+#define __PT_H__
+
+// *************************************************************************************************
+// Include section
+
+#include <core/openchronos.h>
+#include <drivers/timer.h>
+
+
+// *************************************************************************************************
+// Defines section
+
+///	Value returned by a thread function.
+enum pt_state
+{
+	PT_WAITING	= 0, /**< The thread is waiting, call it again later. */
+	PT_ENDED	= 1, /**< The thread has finished. */
+};
+
+//* ************************************************************************************************
+/// @brief	Starts the body of a thread function.
+/// @details	A thread function looks like this, see drivers/buzzer.c for an example:
+/// @code
+/// static enum pt_state my_thread(struct pt *pt)
+/// {
+/// 	PT_BEGIN(pt);
+/// 	...
+/// 	PT_WAIT_MS(pt, 100);
+/// 	...
+/// 	PT_END(pt);
+/// }
+/// @endcode
+/// @note	Threads have no stack of their own: local variables are lost when the thread
+/// 		waits, keep the state in static variables. Do not use switch statements
+/// 		around a wait, nor two waits in the same line.
+//* ************************************************************************************************
+#define PT_BEGIN(pt)		switch ((pt)->lc) { case 0:
+
+/// Ends the body of a thread function.
+#define PT_END(pt)			} (pt)->lc = 0; return PT_ENDED
+
+/// Leaves the thread from anywhere in its body.
+#define PT_EXIT(pt)			do { (pt)->lc = 0; return PT_ENDED; } while (0)
+
+//* ************************************************************************************************
+/// @brief	Waits until a condition is true.
+/// @note	The condition is only checked when the mainloop wakes up, conditions changed
+/// 		from interrupts should come with a message or a timer.
+//* ************************************************************************************************
+#define PT_WAIT_UNTIL(pt, cond)	\
+	do { (pt)->lc = __LINE__; case __LINE__: if (!(cond)) return PT_WAITING; } while (0)
+
+/// Lets the mainloop run once before continuing.
+#define PT_YIELD(pt)	\
+	do { (pt)->lc = __LINE__; pt_yield(); return PT_WAITING; case __LINE__: ; } while (0)
+
+/// Waits \b ms milliseconds, between 1 and 1999, see timer0_swtimer_start().
+#define PT_WAIT_MS(pt, ms)	PT_WAIT_MS_SLACK(pt, ms, 0)
+
+/// Waits \b ms milliseconds, or up to \b slack milliseconds more to share a wakeup.
+#define PT_WAIT_MS_SLACK(pt, ms, slack)	\
+	do { timer0_swtimer_start(&(pt)->timer, (ms), 0, (slack)); \
+	     PT_WAIT_UNTIL(pt, !((pt)->timer.flags & TIMER0_SWTIMER_ARMED)); } while (0)
+
+//* ************************************************************************************************
+/// @brief	Waits until one of the messages in \b msg is delivered by the message bus.
+/// @note	The drivers generate some messages only while a listener is registered in the
+/// 		message bus, see sys_messagebus_register().
+//* ************************************************************************************************
+#define PT_WAIT_MSG(pt, msg)	\
+	do { (pt)->got = 0; (pt)->waits = (msg); \
+	     PT_WAIT_UNTIL(pt, (pt)->got); (pt)->waits = 0; } while (0)
+
+
+// *************************************************************************************************
+// Global Variable section
+
+///	A thread, owned by the caller, usually as a static variable.
+struct pt
+{
+	/// Next thread in the scheduler list
+	struct pt *next;
+
+	/// Thread function, NULL when the thread is not running
+	enum pt_state (*fn)(struct pt *);
+
+	/// Local continuation, the line where the thread resumes
+	uint16_t lc;
+
+	/// Timer used by PT_WAIT_MS()
+	struct timer0_swtimer timer;
+
+	/// Messages awaited by PT_WAIT_MSG()
+	enum sys_message waits;
+
+	/// Awaited messages that were delivered
+	enum sys_message got;
+
+	/// The thread is in the scheduler list
+	uint8_t linked;
+};
+
+
+// *************************************************************************************************
+// Prototypes section
+
+//* ************************************************************************************************
+/// @brief	Starts a thread.
+/// @details	The thread function is called from the mainloop until it returns #PT_ENDED.
+/// 			Starting a running thread restarts it from the beginning.
+//* ************************************************************************************************
+void pt_start(
+	struct pt *pt,						/**< Caller owned thread */
+	enum pt_state (*fn)(struct pt *)	/**< Thread function */
+);
+
+//* ************************************************************************************************
+/// @brief	Stops a thread, wherever it is waiting.
+//* ************************************************************************************************
+void pt_stop(struct pt *pt);
+
+//* ************************************************************************************************
+/// @brief	Checks if a thread is running.
+/// @return	1 if running, 0 otherwise
+//* ************************************************************************************************
+uint8_t pt_running(struct pt *pt);
+
+/// Asks the mainloop to run the threads again, used by PT_YIELD().
+void pt_yield(void);
+
+/// Runs the threads, exclusive use by openchronos system.
+void pt_run(void);
+
+/// Delivers messages to the waiting threads, exclusive use by openchronos system.
+void pt_deliver(enum sys_message msg);
+
+/// Checks if threads have to run, exclusive use by openchronos system.
+uint8_t pt_pending(void);
+
+#endif /* __PT_H__ */
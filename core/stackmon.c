@@ -0,0 +1,207 @@
+/**
+	@file	stackmon.c
+	@brief	Stack high water mark monitor
+
+	@see		http://www.openchronos-ng.sourceforge.net
+	@copyright
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+
+// *************************************************************************************************
+// Include section
+
+#include <core/stackmon.h>
+
+#ifdef CONFIG_STACK_MONITOR
+
+
+// *************************************************************************************************
+// Defines section
+
+#ifndef STACK_TOP
+
+/// End of .bss and .noinit, and top of RAM, from the linker script
+extern uint16_t _end[], __stack[];
+
+#define STACK_BOTTOM	_end
+#define STACK_TOP		__stack
+
+#endif
+
+/// Bytes left unpainted below the stack pointer of stack_paint()
+#ifndef STACK_MARGIN
+#define STACK_MARGIN	0
+#endif
+
+/// Painted words in a row that end the search, a local may hold #STACK_PAINT
+#define STACK_RUN		8
+
+
+// *************************************************************************************************
+// Global Variable section
+
+struct stack_entry stack_table[STACK_ENTRIES];
+
+uint16_t stack_deepest;
+
+/// Lowest address found written so far
+static uint16_t *stack_low;
+
+
+// *************************************************************************************************
+// Functions section
+
+//* ************************************************************************************************
+/// @fn			stack_search
+/// @brief		Search the painted area below the high water mark, with interrupts disabled.
+/// @return		1 if the high water mark moved, 0 otherwise
+//* ************************************************************************************************
+static uint8_t stack_search(void)
+{
+	uint16_t *p = stack_low;
+	uint16_t *low = stack_low;
+	uint8_t run = 0;
+
+	while (p > STACK_BOTTOM && run < STACK_RUN)
+	{
+		if (*--p == STACK_PAINT)
+			run++;
+		else
+		{
+			run = 0;
+			low = p;
+		}
+	}
+
+	if (low == stack_low)
+		return 0;
+
+	stack_low = low;
+	stack_deepest = (uint8_t *)STACK_TOP - (uint8_t *)low;
+
+	return 1;
+}
+
+//* ************************************************************************************************
+/// @fn			stack_paint
+/// @brief		Fill the RAM between .bss and the stack pointer with #STACK_PAINT.
+/// @return		none
+//* ************************************************************************************************
+void stack_paint(void)
+{
+	uint16_t sr = __read_status_register();
+	uint16_t *p = STACK_BOTTOM;
+	uint16_t *end = (uint16_t *)((uint8_t *)__read_stack_pointer() - STACK_MARGIN);
+
+	__dint();
+
+	while (p < end)
+		*p++ = STACK_PAINT;
+
+	stack_low = end;
+
+	__write_status_register(sr);
+}
+
+//* ************************************************************************************************
+/// @fn			stack_leave
+/// @brief		Account a new high water mark to the function that reached it.
+/// @return		none
+//* ************************************************************************************************
+void stack_leave(struct stack_mark *mark)
+{
+	uint16_t sr = __read_status_register();
+	struct stack_entry *e = stack_table;
+
+	__dint();
+
+	if (!stack_search())
+		goto out;
+
+	for (; e < stack_table + STACK_ENTRIES; e++)
+	{
+		if (e->fn == mark->fn || !e->fn)
+			break;
+	}
+
+	// Table full, the function is ignored
+	if (e == stack_table + STACK_ENTRIES)
+		goto out;
+
+	e->fn = mark->fn;
+	e->depth = stack_deepest;
+
+out:
+	__write_status_register(sr);
+}
+
+//* ************************************************************************************************
+/// @fn			stack_used
+/// @brief		Update the high water mark outside of the measured functions.
+/// @return		Deepest stack use in bytes
+//* ************************************************************************************************
+uint16_t stack_used(void)
+{
+	uint16_t sr = __read_status_register();
+
+	__dint();
+
+	stack_search();
+
+	__write_status_register(sr);
+
+	return stack_deepest;
+}
+
+//* ************************************************************************************************
+/// @fn			stack_free
+/// @brief		Bytes between .bss and the high water mark.
+/// @return		Bytes never used
+//* ************************************************************************************************
+uint16_t stack_free(void)
+{
+	stack_used();
+
+	return (uint8_t *)stack_low - (uint8_t *)STACK_BOTTOM;
+}
+
+//* ************************************************************************************************
+/// @fn			stack_reset
+/// @brief		Clear the table and the high water mark, not from interrupt context.
+/// @return		none
+//* ************************************************************************************************
+void stack_reset(void)
+{
+	uint16_t sr = __read_status_register();
+	struct stack_entry *e = stack_table;
+
+	__dint();
+
+	for (; e < stack_table + STACK_ENTRIES; e++)
+	{
+		e->fn = NULL;
+		e->depth = 0;
+	}
+
+	stack_deepest = 0;
+
+	stack_paint();
+
+	__write_status_register(sr);
+}
+
+#endif /* CONFIG_STACK_MONITOR */
@@ -0,0 +1,120 @@
+/**
+	@file	stackmon.h
+	@brief	Stack high water mark monitor
+
+	@see		http://www.openchronos-ng.sourceforge.net
+	@copyright
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	@details	When CONFIG_STACK_MONITOR is set, the free RAM between the end of .bss
+				and the stack pointer is painted with #STACK_PAINT at boot. At the end of
+				each interrupt routine, message bus listener, deferred work, thread and
+				menu button handler, the painted area is searched below the deepest point
+				found so far. When it moved, the new depth is accounted to that function in
+				#stack_table. The results are shown by the STACK module and can be read
+				with mspdebug:
+	@code
+	mspdebug rf2500 "sym find stack_table" "md stack_table 64" "md stack_deepest 2"
+	@endcode
+				Each entry is 4 bytes: function address (2) and depth in bytes (2), little
+				endian. Depths are counted from the top of RAM, compare them against
+				STACK_SIZE in Common.mk.
+	@note		An entry only records the depth at which its function first pushed the
+				high water mark further. Functions that never did are not listed, and the
+				depth includes the interrupts that happened meanwhile. Clear the results
+				before exercising a feature to measure it.
+ */
+
+#ifndef __STACKMON_H__
+#define __STACKMON_H__
+
+// *************************************************************************************************
+// Include section
+
+#include <core/openchronos.h>
+
+
+// *************************************************************************************************
+// Defines section
+
+/// Number of functions that can be accounted, the others are ignored
+#define STACK_ENTRIES	16
+
+/// Value of the unused stack words
+#define STACK_PAINT		0x5AA5
+
+#ifdef CONFIG_STACK_MONITOR
+
+//* ************************************************************************************************
+/// @brief	Accounts the stack used until the end of the enclosing scope to \b fn.
+/// @details	Put it at the very beginning of an interrupt routine, or in a block around a
+/// 			call, next to PROF_SCOPE().
+//* ************************************************************************************************
+#define STACK_SCOPE(fn)	\
+	struct stack_mark __stack_mark __attribute__((cleanup(stack_leave))) = { (void *)(fn) }
+
+#else
+
+#define STACK_SCOPE(fn)
+
+#endif /* CONFIG_STACK_MONITOR */
+
+
+// *************************************************************************************************
+// Global Variable section
+
+///	Deepest stack use seen at the end of a function.
+struct stack_entry
+{
+	void *fn;			/**< Interrupt routine or callback address, NULL if the entry is free */
+	uint16_t depth;		/**< Bytes from the top of RAM */
+};
+
+///	A running measurement, see STACK_SCOPE().
+struct stack_mark
+{
+	void *fn;			/**< Function being measured */
+};
+
+#ifdef CONFIG_STACK_MONITOR
+
+/// The functions that pushed the high water mark, in order of first time.
+extern struct stack_entry stack_table[STACK_ENTRIES];
+
+/// Deepest stack use found so far, in bytes from the top of RAM.
+extern uint16_t stack_deepest;
+
+
+// *************************************************************************************************
+// Prototypes section
+
+/// Paints the unused stack, exclusive use by openchronos system.
+void stack_paint(void);
+
+/// Ends a measurement started by STACK_SCOPE().
+void stack_leave(struct stack_mark *mark);
+
+/// Searches the painted area now and returns #stack_deepest.
+uint16_t stack_used(void);
+
+/// Bytes of stack that were never used.
+uint16_t stack_free(void);
+
+/// Clears the results and paints the stack again.
+void stack_reset(void);
+
+#endif /* CONFIG_STACK_MONITOR */
+
+#endif /* __STACKMON_H__ */
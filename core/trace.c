@@ -0,0 +1,83 @@
+/**
+	@file	trace.c
+	@brief	Event trace recorder
+
+	@see		http://www.openchronos-ng.sourceforge.net
+	@copyright
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+
+// *************************************************************************************************
+// Include section
+
+#include <core/trace.h>
+
+#include <drivers/rtca.h>
+
+#ifdef CONFIG_TRACE
+
+
+// *************************************************************************************************
+// Global Variable section
+
+struct trace trace;
+
+
+// *************************************************************************************************
+// Functions section
+
+//* ************************************************************************************************
+/// @fn			trace_record
+/// @brief		Record an entry, overwriting the oldest one.
+/// @return		none
+//* ************************************************************************************************
+void trace_record(enum trace_kind kind, uint16_t data)
+{
+	struct trace_entry *e = &trace.entry[trace.last];
+
+	// The registers are read as they are, the mainloop may run before the RTC
+	// interrupt that tells about a new minute
+	e->kind = kind;
+	e->hour = rtca_get(RTCHOUR);
+	e->min = rtca_get(RTCMIN);
+	e->sec = rtca_get(RTCSEC);
+	e->ta0 = TA0R;
+	e->data = data;
+
+	trace.last = (trace.last + 1) & (TRACE_SIZE - 1);
+	trace.count++;
+}
+
+//* ************************************************************************************************
+/// @fn			trace_reset
+/// @brief		Clear the trace.
+/// @return		none
+//* ************************************************************************************************
+void trace_reset(void)
+{
+	uint8_t *p = (uint8_t *)&trace;
+	uint16_t i = 0;
+
+	for (; i < sizeof(trace); i++)
+		*p++ = 0;
+}
+
+#if TRACE_SIZE & (TRACE_SIZE - 1)
+#error "TRACE_SIZE must be a power of two"
+#endif
+
+#endif /* CONFIG_TRACE */
@@ -0,0 +1,110 @@
+/**
+	@file	trace.h
+	@brief	Event trace recorder
+
+	@see		http://www.openchronos-ng.sourceforge.net
+	@copyright
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	@details	When CONFIG_TRACE is set, the messages delivered by the mainloop and
+				the button presses it consumes are recorded in #trace, a ring of the last
+				#TRACE_SIZE entries. Each entry is stamped with the RTC time and TA0R, which
+				gives the time between entries to 1/16384s. tools/trace/trace.py reads the
+				ring with mspdebug and turns it into a script for the host simulation:
+	@code
+	tools/trace/trace.py -o field.txt
+	build/host/openchronos field.txt
+	@endcode
+				The layout is the one of struct trace, little endian.
+ */
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+// *************************************************************************************************
+// Include section
+
+#include <core/openchronos.h>
+
+
+// *************************************************************************************************
+// Defines section
+
+/// Number of entries kept, 8 bytes each. The clock delivers a message every second, so
+/// this is half a minute of history when it is shown.
+#ifndef TRACE_SIZE
+#define TRACE_SIZE	32
+#endif
+
+///	What an entry records.
+enum trace_kind
+{
+	TRACE_EMPTY = 0,	/**< Not recorded yet */
+	TRACE_EVENTS,		/**< Messages delivered by check_events(), an #sys_message mask */
+	TRACE_BUTTONS,		/**< Buttons consumed by check_buttons(), a ports_buttons mask */
+};
+
+#ifdef CONFIG_TRACE
+
+/// Records an entry, to be used in the mainloop.
+#define TRACE(kind, data)	trace_record(kind, data)
+
+#else
+
+#define TRACE(kind, data)	do { } while (0)
+
+#endif /* CONFIG_TRACE */
+
+
+// *************************************************************************************************
+// Global Variable section
+
+///	A trace entry.
+struct trace_entry
+{
+	uint8_t kind;	/**< #trace_kind */
+	uint8_t hour;	/**< RTCHOUR, in binary */
+	uint8_t min;	/**< RTCMIN, in binary */
+	uint8_t sec;	/**< RTCSEC, in binary */
+	uint16_t ta0;	/**< TA0R, 16384Hz */
+	uint16_t data;	/**< Message or button mask */
+};
+
+///	The trace ring.
+struct trace
+{
+	uint16_t count;							/**< Entries recorded, overwritten ones too */
+	uint8_t last;							/**< Index of the next entry */
+	uint8_t reserved;
+	struct trace_entry entry[TRACE_SIZE];	/**< Last entries, oldest overwritten */
+};
+
+#ifdef CONFIG_TRACE
+
+extern struct trace trace;
+
+
+// *************************************************************************************************
+// Prototypes section
+
+/// Records an entry, see TRACE().
+void trace_record(enum trace_kind kind, uint16_t data);
+
+/// Clears the trace.
+void trace_reset(void);
+
+#endif /* CONFIG_TRACE */
+
+#endif /* __TRACE_H__ */
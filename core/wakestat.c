@@ -0,0 +1,113 @@
+/**
+	@file	wakestat.c
+	@brief	Wakeup statistics
+
+	@see		http://www.openchronos-ng.sourceforge.net
+	@copyright
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ */
+
+
+// *************************************************************************************************
+// Include section
+
+#include <core/wakestat.h>
+
+#ifdef CONFIG_WAKE_STATS
+
+
+// *************************************************************************************************
+// Global Variable section
+
+struct wake_stats wake_stats;
+
+/// TA0R when the mainloop woke up
+static uint16_t wake_stamp;
+
+
+// *************************************************************************************************
+// Functions section
+
+//* ************************************************************************************************
+/// @fn			wake_stat
+/// @brief		Count an interrupt and keep it in the history, called from interrupt context.
+/// @return		none
+//* ************************************************************************************************
+void wake_stat(enum wake_cause cause)
+{
+	wake_stats.count[cause]++;
+
+	wake_stats.history[wake_stats.last] = cause;
+	wake_stats.last = (wake_stats.last + 1) & (WAKE_HISTORY - 1);
+}
+
+//* ************************************************************************************************
+/// @fn			wake_stat_sleep
+/// @brief		Account the time awake, called with interrupts disabled.
+/// @return		none
+//* ************************************************************************************************
+void wake_stat_sleep(void)
+{
+	wake_stats.awake += (uint16_t)(TA0R - wake_stamp);
+}
+
+//* ************************************************************************************************
+/// @fn			wake_stat_wakeup
+/// @brief		Count a mainloop wakeup.
+/// @return		none
+//* ************************************************************************************************
+void wake_stat_wakeup(void)
+{
+	wake_stamp = TA0R;
+	wake_stats.loops++;
+}
+
+//* ************************************************************************************************
+/// @fn			wake_stat_uptime
+/// @brief		Minutes since the last reset.
+/// @return		minutes
+//* ************************************************************************************************
+uint32_t wake_stat_uptime(void)
+{
+	// The minute interrupt is always enabled
+	return wake_stats.count[WAKE_RTC_MINUTE];
+}
+
+//* ************************************************************************************************
+/// @fn			wake_stat_reset
+/// @brief		Clear the statistics.
+/// @return		none
+//* ************************************************************************************************
+void wake_stat_reset(void)
+{
+	uint8_t *p = (uint8_t *)&wake_stats;
+	uint8_t i = 0;
+
+	__disable_interrupt();
+
+	for (; i < sizeof(wake_stats); i++)
+		*p++ = 0;
+
+	wake_stamp = TA0R;
+
+	__enable_interrupt();
+}
+
+#if WAKE_HISTORY & (WAKE_HISTORY - 1)
+#error "WAKE_HISTORY must be a power of two"
+#endif
+
+#endif /* CONFIG_WAKE_STATS */
@@ -0,0 +1,116 @@
+/**
+	@file	wakestat.h
+	@brief	Wakeup statistics
+
+	@see		http://www.openchronos-ng.sourceforge.net
+	@copyright
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	@details	When CONFIG_WAKE_STATS is set, every interrupt is counted by cause, the
+				mainloop wakeups are counted and the time the mainloop spends awake is
+				measured with TA0R. The time in LPM3 is the uptime, counted in RTC minute
+				interrupts, minus the awake time. The results are shown by the STAT module
+				and kept in #wake_stats, which can be read with mspdebug:
+	@code
+	mspdebug rf2500 "sym find wake_stats" "md wake_stats 74"
+	@endcode
+				The layout is the one of struct wake_stats, little endian.
+	@note		Interrupt routines are not part of the awake time, see core/profile.h.
+ */
+
+#ifndef __WAKESTAT_H__
+#define __WAKESTAT_H__
+
+// *************************************************************************************************
+// Include section
+
+#include <core/openchronos.h>
+
+
+// *************************************************************************************************
+// Defines section
+
+/// Number of wake causes kept in the history
+#define WAKE_HISTORY	16
+
+///	Interrupt causes that wake up the CPU.
+enum wake_cause
+{
+	WAKE_RTC_SECOND = 0,	/**< RTC read ready (second) */
+	WAKE_RTC_MINUTE,		/**< RTC time event (minute) */
+	WAKE_RTC_ALARM,			/**< RTC alarm */
+	WAKE_TA0_CCR0,			/**< Timer0 20Hz */
+	WAKE_TA0_CCR1,			/**< Timer0 software timers */
+	WAKE_TA0_CCR4,			/**< Timer0 delay */
+	WAKE_TA0_OVF,			/**< Timer0 overflow (4s) */
+	WAKE_PORT2_BUTTON,		/**< Button press or release */
+	WAKE_PORT2_ACCEL,		/**< Accelerometer interrupt */
+	WAKE_PORT2_PRESSURE,	/**< Pressure sensor interrupt */
+	WAKE_RADIO,				/**< Radio core */
+	WAKE_ADC12,				/**< ADC12 conversion */
+	WAKE_CAUSES
+};
+
+#ifdef CONFIG_WAKE_STATS
+
+/// Counts an interrupt, to be used in interrupt routines.
+#define WAKE_STAT(cause)	wake_stat(cause)
+
+#else
+
+#define WAKE_STAT(cause)
+
+#endif /* CONFIG_WAKE_STATS */
+
+
+// *************************************************************************************************
+// Global Variable section
+
+///	The wakeup statistics.
+struct wake_stats
+{
+	uint32_t count[WAKE_CAUSES];	/**< Interrupts per #wake_cause */
+	uint32_t loops;					/**< Mainloop wakeups from LPM3 */
+	uint32_t awake;					/**< Mainloop awake time, in 1/16384s */
+	uint8_t last;					/**< Index of the next history entry */
+	uint8_t history[WAKE_HISTORY];	/**< Last wake causes, oldest overwritten */
+};
+
+#ifdef CONFIG_WAKE_STATS
+
+extern struct wake_stats wake_stats;
+
+
+// *************************************************************************************************
+// Prototypes section
+
+/// Counts an interrupt, see WAKE_STAT().
+void wake_stat(enum wake_cause cause);
+
+/// The mainloop goes to sleep, exclusive use by openchronos system.
+void wake_stat_sleep(void);
+
+/// The mainloop woke up, exclusive use by openchronos system.
+void wake_stat_wakeup(void);
+
+/// Minutes counted since the last reset.
+uint32_t wake_stat_uptime(void);
+
+/// Clears the statistics.
+void wake_stat_reset(void);
+
+#endif /* CONFIG_WAKE_STATS */
+
+#endif /* __WAKESTAT_H__ */
@@ -44,6 +44,9 @@
 
 // System
 #include <core/openchronos.h>
+#include <core/profile.h>
+#include <core/stackmon.h>
+#include <core/wakestat.h>
 
 // Driver
 #include "adc12.h"
@@ -130,6 +133,10 @@ __interrupt
 //* ************************************************************************************************
 void ADC12ISR(void)
 {
+	STACK_SCOPE(ADC12ISR);
+	PROF_SCOPE(ADC12ISR);
+	WAKE_STAT(WAKE_ADC12);
+	
 	switch (__even_in_range(ADC12IV, 34))
 	{
 		case  0:						// Vector  0:  No interrupt
@@ -20,6 +20,7 @@
  */
 
 #include <core/openchronos.h>
+#include <core/pt.h>
 
 
 #include "buzzer.h"
@@ -45,20 +46,30 @@ uint16_t base_notes[13] = {
 	1262  /* C: G# */
 };
 
+/* the melody is played by a thread, in the background */
+static struct pt buzzer_pt;
+static note *buzzer_notes;
+
+/* Play "welcome" chord: A major */
+static note welcome[4] = {0x1901, 0x1904, 0x1908, 0x000F};
+
 inline void buzzer_init(void)
 {
+#ifdef CONFIG_PROFILE
+	/* TA1 is used by the profiler, the buzzer is muted */
+	return;
+#endif
+
 	/* Reset TA1R, TA1 runs from 32768Hz ACLK */
 	TA1CTL = TACLR | TASSEL__SMCLK | MC__STOP;
 
 	/* Enable IRQ, set output mode "toggle" */
 	TA1CCTL0 = OUTMOD_4;
 
-	/* Play "welcome" chord: A major */
-	note welcome[4] = {0x1901, 0x1904, 0x1908, 0x000F};
 	buzzer_play(welcome);
 }
 
-inline void buzzer_stop(void)
+static void buzzer_stop(void)
 {
 	/* Stop PWM timer */
 	TA1CTL &= ~MC_3;
@@ -69,35 +80,59 @@ inline void buzzer_stop(void)
 
 	/* Clear PWM timer interrupt */
 	TA1CCTL0 &= ~CCIE;
+
+	/* Abort the melody, SMCLK is not needed anymore */
+	if (pt_running(&buzzer_pt)) {
+		pt_stop(&buzzer_pt);
+		sys_smclk_keep(0);
+	}
 }
 
-void buzzer_play(note *notes)
+static enum pt_state buzzer_thread(struct pt *pt)
 {
+	PT_BEGIN(pt);
 
 	/* Allow buzzer PWM output on P2.7 */
 	P2SEL |= BIT7;
 
 	/* 0x000F is the "stop bit" */
-	while (PITCH(*notes) != 0x000F) {
-		if (PITCH(*notes) == 0) {
+	while (PITCH(*buzzer_notes) != 0x000F) {
+		if (PITCH(*buzzer_notes) == 0) {
 			/* Stop the timer! We are playing a rest */
 			TA1CTL &= ~MC_3;
 		} else {
 			/* Set PWM frequency */
-			TA1CCR0 = base_notes[PITCH(*notes)] >> OCTAVE(*notes);
+			TA1CCR0 = base_notes[PITCH(*buzzer_notes)] >> OCTAVE(*buzzer_notes);
 
 			/* Start the timer */
 			TA1CTL |= MC__UP;
 		}
 
-		/* Delay for DURATION(*notes) milliseconds,
-		   use LPM1 because we need SMCLK for tone generation */
-		timer0_delay(DURATION(*notes), LPM1_bits);
+		/* Wait for DURATION(*notes) milliseconds, the mainloop
+		   uses LPM1 meanwhile because we need SMCLK for tone generation */
+		PT_WAIT_MS(pt, DURATION(*buzzer_notes));
 
 		/* Advance to the next note */
-		notes++;
+		buzzer_notes++;
 	}
 
 	/* Stop buzzer */
 	buzzer_stop();
+
+	PT_END(pt);
+}
+
+void buzzer_play(note *notes)
+{
+#ifdef CONFIG_PROFILE
+	/* TA1 is used by the profiler, the buzzer is muted */
+	return;
+#endif
+
+	/* a melody already playing is replaced */
+	if (!pt_running(&buzzer_pt))
+		sys_smclk_keep(1);
+
+	buzzer_notes = notes;
+	pt_start(&buzzer_pt, buzzer_thread);
 }
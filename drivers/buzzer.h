@@ -35,7 +35,10 @@ void buzzer_init(void);
 
 /*!
  * \brief Play a sequence of notes using the buzzer.
- * \param notes An array of notes to play.
+ * \details The notes are played in the background, this function returns
+ * immediately. Playing while a melody is playing replaces it.
+ * \param notes An array of notes to play, it must stay valid until
+ * the melody ends (eg. a static array).
  */
 void buzzer_play(note *notes);
 
@@ -55,26 +55,30 @@
 // *************************************************************************************************
 
 #include <core/openchronos.h>
+#include <core/profile.h>
+#include <core/stackmon.h>
 #include <string.h>
-#include <stdlib.h>
 #include "display.h"
 
 /* Swap nibble */
 #define SWAP_NIBBLE(x)              ((((x) << 4) & 0xF0) | (((x) >> 4) & 0x0F))
 
-/* LCD controller memory map */
-#define LCD_MEM_1          			((uint8_t*)0x0A20)
-#define LCD_MEM_2          			((uint8_t*)0x0A21)
-#define LCD_MEM_3          			((uint8_t*)0x0A22)
-#define LCD_MEM_4          			((uint8_t*)0x0A23)
-#define LCD_MEM_5          			((uint8_t*)0x0A24)
-#define LCD_MEM_6          			((uint8_t*)0x0A25)
-#define LCD_MEM_7          			((uint8_t*)0x0A26)
-#define LCD_MEM_8          	 		((uint8_t*)0x0A27)
-#define LCD_MEM_9          			((uint8_t*)0x0A28)
-#define LCD_MEM_10         			((uint8_t*)0x0A29)
-#define LCD_MEM_11         			((uint8_t*)0x0A2A)
-#define LCD_MEM_12         			((uint8_t*)0x0A2B)
+/* LCD controller memory map, the host simulation build moves it */
+#ifndef LCD_MEM_BASE
+#define LCD_MEM_BASE				((uint8_t*)0x0A20)
+#endif
+#define LCD_MEM_1          			(LCD_MEM_BASE + 0x00)
+#define LCD_MEM_2          			(LCD_MEM_BASE + 0x01)
+#define LCD_MEM_3          			(LCD_MEM_BASE + 0x02)
+#define LCD_MEM_4          			(LCD_MEM_BASE + 0x03)
+#define LCD_MEM_5          			(LCD_MEM_BASE + 0x04)
+#define LCD_MEM_6          			(LCD_MEM_BASE + 0x05)
+#define LCD_MEM_7          			(LCD_MEM_BASE + 0x06)
+#define LCD_MEM_8          	 		(LCD_MEM_BASE + 0x07)
+#define LCD_MEM_9          			(LCD_MEM_BASE + 0x08)
+#define LCD_MEM_10         			(LCD_MEM_BASE + 0x09)
+#define LCD_MEM_11         			(LCD_MEM_BASE + 0x0A)
+#define LCD_MEM_12         			(LCD_MEM_BASE + 0x0B)
 
 
 /* Memory assignment */
@@ -168,6 +172,7 @@
 #define LCD_SEG_MEM     (LCD_MEM_1)
 #define LCD_BLK_MEM   (LCD_MEM_1 + 0x20)
 #define LCD_MEM_LEN   12
+#define LCD_MEM_ALL   ((1u << LCD_MEM_LEN) - 1)
 
 /***************************************************************************
  ***************************** LOCAL STORAGE *******************************
@@ -178,11 +183,48 @@
 /* storage for itoa function */
 static char sprintf_str[SPRINTF_STR_LEN];
 
-/* pointer to active screen */
+/* all display calls write into this copy of the LCD memory, and mark the
+   bytes they changed in display_dirty. display_commit() copies them to the
+   LCD controller once per mainloop iteration */
+static uint8_t display_shadow_seg[LCD_MEM_LEN] __attribute__((aligned(2)));
+static uint8_t display_shadow_blk[LCD_MEM_LEN] __attribute__((aligned(2)));
+static uint16_t display_dirty;
+
+/* queued when the next commit reached the LCD memory */
+static void (*display_commit_fn)(void);
+
+/* the memory display_commit() copies from: the shadow, or the buffers of
+   the active screen */
+static uint8_t *display_shown_seg = display_shadow_seg;
+static uint8_t *display_shown_blk = display_shadow_blk;
+
+/* pointer to active screen, NULL if no screens were created */
 static struct lcd_screen *display_screens;
 static uint8_t display_nrscreens;
 static uint8_t display_activescr;
 
+/* the screens come from a static pool; screen 0 uses the shadow memory,
+   the others one of the buffers each. They keep their memory until they are
+   destroyed, activating one only changes the shown memory */
+static struct lcd_screen display_screen_pool[CONFIG_DISPLAY_SCREENS];
+static uint8_t display_screen_segmem[CONFIG_DISPLAY_SCREENS - 1][LCD_MEM_LEN]
+	__attribute__((aligned(2)));
+static uint8_t display_screen_blkmem[CONFIG_DISPLAY_SCREENS - 1][LCD_MEM_LEN]
+	__attribute__((aligned(2)));
+
+#ifdef CONFIG_DISPLAY_DMA
+/* software triggered block transfers of LCD_MEM_LEN bytes as words, on DMA
+   channel 0. A copy increments both addresses, a fill repeats the source */
+#define DISPLAY_DMA_COPY	(DMADT_1 | DMASRCINCR_3 | DMADSTINCR_3)
+#define DISPLAY_DMA_FILL	(DMADT_1 | DMASRCINCR_0 | DMADSTINCR_3)
+
+static const uint16_t display_dma_zero;
+#endif
+
+#if CONFIG_DISPLAY_SCREENS < 2
+#error "CONFIG_DISPLAY_SCREENS must be at least 2"
+#endif
+
 /* 7-segment character bit assignments */
 #define SEG_A     (BIT4)
 #define SEG_B     (BIT5)
@@ -348,28 +390,58 @@ static const uint8_t segments_bitmask[] = {
  ***************************** LOCAL FUNCTIONS *****************************
  **************************************************************************/
 
-static void write_lcd_mem(uint8_t *segmem, uint8_t *blkmem,
+/* returns 1 if the memory changed */
+static uint8_t write_lcd_mem(uint8_t *segmem, uint8_t *blkmem,
                   uint8_t bits, uint8_t bitmask, uint8_t state)
 {
+	uint8_t seg = *segmem;
+	uint8_t blk = *blkmem;
+
 	if ( (state | SEG_OFF) == state) {
 		// Clear all segments
-		*segmem = (uint8_t)(*segmem & ~bitmask);
+		seg &= ~bitmask;
 	}
 
 	if ( (state | SEG_ON) == state) {
 		// Set visible segments
-		*segmem = (uint8_t)(*segmem | bits);
+		seg |= bits;
 	}
 
 	if ( (state | BLINK_OFF) == state) {
 		// Clear blink segments
-		*blkmem = (uint8_t)(*blkmem & ~bitmask);
+		blk &= ~bitmask;
 	}
 
 	if ( (state | BLINK_ON) == state) {
 		// Set blink segments
-		*blkmem = (uint8_t)(*blkmem | bits);
+		blk |= bits;
 	}
+
+	if (seg == *segmem && blk == *blkmem)
+		return 0;
+
+	*segmem = seg;
+	*blkmem = blk;
+
+	return 1;
+}
+
+/* writes a byte of a screen, offset bytes from LCD_MEM_1. The changes of
+   the shown screen are marked for display_commit() */
+static void display_write(uint8_t scr_nr, uint8_t offset,
+                  uint8_t bits, uint8_t bitmask, uint8_t state)
+{
+	uint8_t *segmem = display_shadow_seg;
+	uint8_t *blkmem = display_shadow_blk;
+
+	if (display_screens) {
+		segmem = display_screens[scr_nr].segmem;
+		blkmem = display_screens[scr_nr].blkmem;
+	}
+
+	if (write_lcd_mem(segmem + offset, blkmem + offset, bits, bitmask, state)
+	    && segmem == display_shown_seg)
+		display_dirty |= 1u << offset;
 }
 
 /***************************************************************************
@@ -381,6 +453,11 @@ void lcd_init(void)
 	// Clear entire display memory
 	LCDBMEMCTL |= LCDCLRBM + LCDCLRM;
 
+#ifdef CONFIG_DISPLAY_DMA
+	// DMA channel 0 is started by software (DMAREQ)
+	DMACTL0 = (DMACTL0 & 0xff00) | DMA0TSEL_0;
+#endif
+
 	// LCD_FREQ = ACLK/12/8 = 341.3Hz flickers in the sun
 	// LCD_FREQ = ACLK/10/8 = 409.6Hz still flickers in the sun when watch is moving (might be negligible)
 
@@ -410,22 +487,27 @@ void lcd_init(void)
 */
 void lcd_screens_create(uint8_t nr)
 {
-	/* allocate memory */
+	/* screens above the pool size are not available */
+	if (nr > CONFIG_DISPLAY_SCREENS)
+		nr = CONFIG_DISPLAY_SCREENS;
+
 	display_nrscreens = nr;
-	display_screens = malloc(sizeof(struct lcd_screen) * nr);
+	display_screens = display_screen_pool;
 
 	/* the first screen is the active one */
 	display_activescr = 0;
-	display_screens[0].segmem = LCD_SEG_MEM;
-	display_screens[0].blkmem = LCD_BLK_MEM;
+	display_shown_seg = display_shadow_seg;
+	display_shown_blk = display_shadow_blk;
+	display_screens[0].segmem = display_shadow_seg;
+	display_screens[0].blkmem = display_shadow_blk;
 
-	/* allocate mem for the remaining and copy real screen over */
+	/* take buffers for the remaining and copy real screen over */
 	uint8_t i = 1;
 	for (; i<nr; i++) {
-		display_screens[i].segmem = malloc(LCD_MEM_LEN);
-		display_screens[i].blkmem = malloc(LCD_MEM_LEN);
-		memcpy(display_screens[i].segmem, LCD_SEG_MEM, LCD_MEM_LEN);
-		memcpy(display_screens[i].blkmem, LCD_BLK_MEM, LCD_MEM_LEN);
+		display_screens[i].segmem = display_screen_segmem[i - 1];
+		display_screens[i].blkmem = display_screen_blkmem[i - 1];
+		memcpy(display_screens[i].segmem, display_shadow_seg, LCD_MEM_LEN);
+		memcpy(display_screens[i].blkmem, display_shadow_blk, LCD_MEM_LEN);
 	}
 }
 
@@ -434,29 +516,15 @@ void lcd_screens_create(uint8_t nr)
 */
 void lcd_screens_destroy(void)
 {
-	uint8_t i = 0;
-
 	/* switch to screen 0 and display any pending data */
 	lcd_screen_activate(0);
 
-	/* now we can delete all the screens */
-	for (; i<display_nrscreens; i++) {
-		if (i != display_activescr) {
-			free(display_screens[i].segmem);
-			free(display_screens[i].blkmem);
-		}
-		display_screens[i].segmem = NULL;
-		display_screens[i].segmem = NULL;
-	}
-
-	free(display_screens);
+	/* the buffers go back to the pool */
 	display_screens = NULL;
 }
 
 /*
 	lcd_screen_activate()
-   - the memory pointed by display_screens is assumed to be on
-	contiguos memory
 	if scr_nr == 0xff, then activate next screen.
 */
 void lcd_screen_activate(uint8_t scr_nr)
@@ -468,25 +536,87 @@ void lcd_screen_activate(uint8_t scr_nr)
 	else
 		display_activescr = scr_nr;
 
-	/* allocate memory for previous screen */
-	display_screens[prevscr].segmem = malloc(LCD_MEM_LEN);
-	display_screens[prevscr].blkmem = malloc(LCD_MEM_LEN);
-
-	/* copy real screen contents to previous screen */
-	memcpy(display_screens[prevscr].segmem, LCD_SEG_MEM, LCD_MEM_LEN);
-	memcpy(display_screens[prevscr].blkmem, LCD_BLK_MEM, LCD_MEM_LEN);
-
-	/* update real screen with contents from activated screen */
-	memcpy(LCD_SEG_MEM, display_screens[display_activescr].segmem, LCD_MEM_LEN);
-	memcpy(LCD_BLK_MEM, display_screens[display_activescr].blkmem, LCD_MEM_LEN);
-	
-	/* free memory from the activated screen */
-	free(display_screens[display_activescr].segmem);
-	free(display_screens[display_activescr].blkmem);
-
-	/* set activated screen as real screen output */
-	display_screens[display_activescr].segmem = LCD_SEG_MEM;
-	display_screens[display_activescr].blkmem = LCD_BLK_MEM;
+	if (display_activescr == prevscr)
+		return;
+
+	/* set activated screen as real screen output, all of it is copied to
+	   the LCD memory at the next commit */
+	display_shown_seg = display_screens[display_activescr].segmem;
+	display_shown_blk = display_screens[display_activescr].blkmem;
+	display_dirty = LCD_MEM_ALL;
+}
+
+#ifdef CONFIG_DISPLAY_DMA
+/* transfers a screen memory. The CPU is held until the whole block is done,
+   DMAEN is already clear when it resumes */
+static void display_dma(uint16_t ctl, const void *src, void *dst)
+{
+	DMA0SA = (uintptr_t)src;
+	DMA0DA = (uintptr_t)dst;
+	DMA0SZ = LCD_MEM_LEN / 2;
+
+	DMA0CTL = ctl | DMAEN;
+	DMA0CTL |= DMAREQ;
+
+	while (DMA0CTL & DMAEN);
+}
+
+/* the end of a commit with a function waiting in display_commit_fn */
+__attribute__((interrupt(DMA_VECTOR)))
+void DMA_ISR(void)
+{
+	STACK_SCOPE(DMA_ISR);
+	PROF_SCOPE(DMA_ISR);
+
+	/* reading DMAIV automatically resets the interrupt flag */
+	if (DMAIV == DMAIV_DMA0IFG && display_commit_fn) {
+		sys_workqueue_add(display_commit_fn);
+		display_commit_fn = NULL;
+
+		/* exit from LPM3, give execution back to mainloop */
+		_BIC_SR_IRQ(LPM3_bits);
+	}
+}
+#endif
+
+void display_commit_callback(void (*fn)(void))
+{
+	display_commit_fn = fn;
+}
+
+void display_commit(void)
+{
+	uint16_t sr = __read_status_register();
+	uint16_t dirty;
+	uint8_t i = 0;
+
+	/* an interrupt may draw meanwhile, it is committed the next time */
+	__dint();
+	dirty = display_dirty;
+	display_dirty = 0;
+	__write_status_register(sr);
+
+#ifdef CONFIG_DISPLAY_DMA
+	/* a whole new screen, the completion interrupt queues the callback */
+	if (dirty == LCD_MEM_ALL) {
+		display_dma(DISPLAY_DMA_COPY, display_shown_seg, LCD_SEG_MEM);
+		display_dma(DISPLAY_DMA_COPY | (display_commit_fn ? DMAIE : 0),
+		            display_shown_blk, LCD_BLK_MEM);
+		return;
+	}
+#endif
+
+	for (; dirty; i++, dirty >>= 1) {
+		if (dirty & 1) {
+			LCD_SEG_MEM[i] = display_shown_seg[i];
+			LCD_BLK_MEM[i] = display_shown_blk[i];
+		}
+	}
+
+	if (display_commit_fn) {
+		sys_workqueue_add(display_commit_fn);
+		display_commit_fn = NULL;
+	}
 }
 
 void display_clear(uint8_t scr_nr, uint8_t line)
@@ -503,15 +633,41 @@ void display_clear(uint8_t scr_nr, uint8_t line)
 		display_symbol(scr_nr, LCD_SEG_L2_COL0, SEG_OFF);
 	} else {
 		uint8_t *lcdptr = (display_screens ?
-		            display_screens[scr_nr].segmem : (uint8_t *)LCD_SEG_MEM);
+		            display_screens[scr_nr].segmem : display_shadow_seg);
+		if (lcdptr == display_shown_seg)
+			display_dirty = LCD_MEM_ALL;
+
+#ifdef CONFIG_DISPLAY_DMA
+		display_dma(DISPLAY_DMA_FILL, &display_dma_zero, lcdptr);
+#else
 		uint8_t i = 1;
 
 		for (; i <= 12; i++) {
 			*(lcdptr++) = 0x00;
 		}
+#endif
 	}
 }
 
+/* n / 10 as (n * 0xcccd) >> 19, exact for all 16bit n. The MPY32 is
+   shared with the interrupt routines, it is used with them disabled */
+static uint16_t display_div10(uint16_t n)
+{
+#ifdef __MSP430_HAS_MPY32__
+	uint16_t sr = __read_status_register();
+
+	__dint();
+	MPY = n;
+	OP2 = 0xcccd;
+	n = RESHI;
+	__write_status_register(sr);
+
+	return n >> 3;
+#else
+	return ((uint32_t)n * 0xcccd) >> 19;
+#endif
+}
+
 char *_sprintf(const char *fmt, int16_t n) {
 	int8_t i = 0;
 	int8_t j = 0;
@@ -559,8 +715,9 @@ char *_sprintf(const char *fmt, int16_t n) {
 			} while (n > 0);
 		} else {
 			do {
-				sprintf_str[j--] = n % 10 + '0';
-				n /= 10;
+				uint16_t q = display_div10(n);
+				sprintf_str[j--] = (uint16_t)n - ((q << 3) + (q << 1)) + '0';
+				n = q;
 				digits--;
 			} while (n > 0);
 		}
@@ -602,24 +759,15 @@ void display_symbol(uint8_t scr_nr, enum display_segment symbol,
                                                enum display_segstate state)
 {
 	if (symbol <= LCD_SEG_L2_DP) {
-		// Get LCD memory address for symbol from table
-		uint8_t *segmem = (uint8_t *)segments_lcdmem[symbol];
-		uint8_t *blkmem = segmem + 0x20;
-
-		if (display_screens) {
-			/* get offset */
-			uint8_t offset = segmem - LCD_MEM_1;
-			
-			segmem = display_screens[scr_nr].segmem + offset;
-			blkmem = display_screens[scr_nr].blkmem + offset;
-		}
+		// Get LCD memory offset for symbol from table
+		uint8_t offset = segments_lcdmem[symbol] - LCD_MEM_1;
 
 		// Get bits for symbol from table
 		uint8_t bits 	= segments_bitmask[symbol];
 
 		// Write LCD memory
 		// (bitmask for symbols equals bits)
-		write_lcd_mem(segmem, blkmem, bits, bits, state);
+		display_write(scr_nr, offset, bits, bits, state);
 	}
 }
 
@@ -628,17 +776,8 @@ void display_bits(uint8_t scr_nr, enum display_segment segment,
 {
 	// Write to single 7-segment character
 	if ((segment >= LCD_SEG_L1_3) && (segment <= LCD_SEG_L2_DP)) {
-		// Get LCD memory address for segment from table
-		uint8_t *segmem = (uint8_t *)segments_lcdmem[segment];
-		uint8_t *blkmem = segmem + 0x20;
-
-		if (display_screens) {
-			/* get offset */
-			uint8_t offset = segmem - LCD_MEM_1;
-
-			segmem = display_screens[scr_nr].segmem + offset;
-			blkmem = display_screens[scr_nr].blkmem + offset;
-		}
+		// Get LCD memory offset for segment from table
+		uint8_t offset = segments_lcdmem[segment] - LCD_MEM_1;
 
         // Get bitmask for character from table
         uint8_t bitmask = segments_bitmask[segment];
@@ -649,8 +788,8 @@ void display_bits(uint8_t scr_nr, enum display_segment segment,
 			bits = SWAP_NIBBLE(bits);
 		}
 
-		// Physically write to LCD memory
-		write_lcd_mem(segmem, blkmem, bits, bitmask, state);
+		// Write to the screen memory
+		display_write(scr_nr, offset, bits, bitmask, state);
 	}
 }
 
@@ -696,6 +835,73 @@ void display_chars(uint8_t scr_nr,
 	}
 }
 
+void display_bcd(uint8_t scr_nr,
+                 enum display_segment_array segments,
+                 uint16_t bcd,
+                 enum display_segstate state)
+{
+	uint8_t len = (segments & 0x0f);
+	uint8_t segment = 38 - (segments >> 4) + len;
+
+	/* from the rightmost digit, the font starts with '0' to '9' */
+	for (; len; len--, bcd >>= 4)
+		display_bits(scr_nr, --segment, lcd_font[bcd & 0x0f], state);
+}
+
+void display_number(uint8_t scr_nr,
+                    enum display_segment_array segments,
+                    int16_t n, uint8_t fmt,
+                    enum display_segstate state)
+{
+	uint8_t first = 38 - (segments >> 4);
+	uint8_t segment = first + (segments & 0x0f);
+	uint8_t digits = fmt & 0x0f;
+	uint16_t u = n;
+	uint16_t q;
+	uint8_t d;
+	uint8_t bits;
+
+	if ((fmt & NUM_SIGNED) && n < 0)
+		u = -n;
+
+	/* from the rightmost digit, until the number and the zeros are shown */
+	do {
+		if (fmt & NUM_HEX) {
+			d = u & 0x0f;
+			u >>= 4;
+
+			/* 'A' comes 7 characters after '9' in the font */
+			if (d > 9)
+				d += 7;
+		} else {
+			q = display_div10(u);
+			d = u - ((q << 3) + (q << 1));
+			u = q;
+		}
+
+		bits = lcd_font[d];
+
+		/* see display_char(), LCD_SEG_L2_5 only has the segment of a '1'
+		   and shares its byte with LCD_SEG_L2_4 */
+		if (--segment == LCD_SEG_L2_5)
+			bits = (d == 1 ? SWAP_NIBBLE(BIT7) : 0);
+
+		display_bits(scr_nr, segment, bits, state);
+
+		if (digits)
+			digits--;
+	} while (segment > first && (u || digits));
+
+	/* blanks, then the sign in the first segment */
+	while (segment > first + 1)
+		display_bits(scr_nr, --segment, 0, state);
+
+	if (segment > first) {
+		bits = ((fmt & NUM_SIGNED) && n < 0 && first != LCD_SEG_L2_5) ? BIT1 : 0;
+		display_bits(scr_nr, first, bits, state);
+	}
+}
+
 // *************************************************************************************************
 // @fn          start_blink
 // @brief       Start blinking.
@@ -729,6 +935,7 @@ void stop_blink(void)
 void clear_blink_mem(void)
 {
 	LCDBMEMCTL |= LCDCLRBM;
+	memset(display_shown_blk, 0, LCD_MEM_LEN);
 }
 
 
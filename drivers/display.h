@@ -69,6 +69,11 @@
 // *************************************************************************************************
 // Defines section
 
+/// Size of the virtual screen pool, see lcd_screens_create()
+#ifndef CONFIG_DISPLAY_SCREENS
+#define CONFIG_DISPLAY_SCREENS	3
+#endif
+
 //* ************************************************************************************************
 /// @brief		pseudo printf function
 /// 
@@ -76,7 +81,9 @@
 /// 			the string containing the number <i>n</i> formatted according to <i>fmt</i>.
 /// 			This function is equivalent to calling
 /// 			display_chars(scr_nr, segments, _sprintf(fmt, n), SEG_SET).
-/// @see		display_chars, _sprintf
+/// @note		display_number() shows the same numbers without parsing a format nor
+/// 			building a string.
+/// @see		display_chars, _sprintf, display_number
 //* ************************************************************************************************
 
 #define _printf(scr_nr, segments, fmt, n) \
@@ -97,6 +104,13 @@ enum display_segstate
 	BLINK_SET	= 12u /**< Turn blinking OFF on all bits of segment, then turn blinking ON on only selected bits */
 };
 
+/// Flags of display_number(), or-ed with the minimum number of digits (0 to 15)
+enum display_numfmt
+{
+	NUM_SIGNED	= 0x10u, /**< The first segment shows '-' or blank */
+	NUM_HEX		= 0x20u  /**< Hexadecimal digits, otherwise decimal */
+};
+
 /// Enumeration of all ez430 chronos LCD segments
 enum display_segment
 {
@@ -226,14 +240,13 @@ void lcd_init(void);
 /// 
 /// After creating the virtual screens using this function,
 /// the screen 0 is always selected as the active screen. This means
-/// that any writes to screen 0 will actually be imediately displayed
-/// on the real screen, while writes to other screens will be saved until
+/// that any writes to screen 0 will actually be displayed
+/// on the real screen at the next display_commit(), while writes to other screens will be saved until
 /// lcd_screen_activate() is called.
 /// 
-/// @note	Each virtual screen takes 24bytes of memory. It is less than the code that you would
-/// 		actually need to write to handle the cases where these functions are meant to be used.
-/// 		However, RAM memory on the ez430 chronos is limited too
-/// 		so don't use a bazilion of screens.
+/// @note	The screens come from a static pool of #CONFIG_DISPLAY_SCREENS, each one takes 24bytes
+/// 		of RAM whether it is used or not. <i>nr</i> is limited to the pool size, raise
+/// 		CONFIG_DISPLAY_SCREENS if a module needs more screens.
 /// @note	Never, ever forget to destroy the created screens using lcd_screens_destroy() !
 /// @see	lcd_screens_destroy(), lcd_screen_activate()
 //* ************************************************************************************************
@@ -254,7 +267,9 @@ void lcd_screens_destroy(void);
 /// 			See lcd_screens_create() on how to create virtual screens.<br />
 /// 
 /// This function selects the active screen. The active screen is the screen where any writes to
-/// it will be imediately displayed in the real screen.
+/// it will be displayed in the real screen at the next display_commit().
+/// Each screen keeps its own memory, activating one copies nothing: the next commit
+/// rewrites the 24 bytes of the LCD memory from the activated screen.
 /// 
 /// @note If you set the <i>scr_nr</i> to 0xff, the next screen will be automatically activated.
 /// @see lcd_screens_destroy(), lcd_screens_create()
@@ -263,6 +278,30 @@ void lcd_screen_activate(
 	uint8_t scr_nr /**< the screen number to activate, or 0xff */
 );
 
+//* ************************************************************************************************
+/// @brief		Copies the screen to the LCD controller
+/// @details	The display functions write into a shadow of the LCD memory and mark the bytes
+/// 			they changed. This function copies only those bytes to the LCD memory, so a
+/// 			screen drawn in several calls shows up at once. It is called by the system once
+/// 			per mainloop iteration, before sleeping.
+/// @note Modules are strictly forbidden to call this function.
+/// @internal
+//* ************************************************************************************************
+void display_commit(void);
+
+//* ************************************************************************************************
+/// @brief		Chains work after the next display update
+/// @details	Queues <i>fn</i> to the mainloop with sys_workqueue_add() once the next
+/// 			display_commit() has written the LCD memory, so the caller can continue after
+/// 			the screen it drew is really shown. A new function replaces the waiting one.
+/// 			With CONFIG_DISPLAY_DMA, whole screens (after lcd_screen_activate() or
+/// 			display_clear()) are copied by DMA channel 0 and its completion interrupt queues
+/// 			<i>fn</i>.
+//* ************************************************************************************************
+void display_commit_callback(
+	void (*fn)(void)	/**< the function to queue, or NULL to cancel */
+);
+
 // Not to be used by modules
 void start_blink(void);
 void stop_blink(void);
@@ -380,6 +419,65 @@ void display_chars(
 	enum display_segstate state				/**< A bitfield with state operations to be performed on the segment */
 );
 
+//* ************************************************************************************************
+/// @brief		Displays a packed BCD number
+/// @details	Shows one decimal digit per nibble of <i>bcd</i>, the lowest nibble on the
+/// 			rightmost segment of <i>segments</i>, zero padded. The nibbles are looked up in
+/// 			the font directly, unlike _sprintf() there is no division.
+/// Example:
+/// @code
+/// 	// shows "0930" on the first line
+/// 	display_bcd(0, LCD_SEG_L1_3_0, 0x0930, SEG_SET);
+/// @endcode
+/// @see	display_chars(), rtca_bcd
+//* ************************************************************************************************
+void display_bcd(
+	uint8_t scr_nr,							/**< The virtual screen number where to display */
+	enum display_segment_array segments,	/**< A segment array, up to 4 segments */
+	uint16_t bcd,							/**< The digits, 4 bits each */
+	enum display_segstate state				/**< A bitfield with state operations to be performed on the segment */
+);
+
+//* ************************************************************************************************
+/// @brief		Displays a number
+/// @details	Writes the digits of <i>n</i> to <i>segments</i>, right aligned, without going
+/// 			through a string. The digits are looked up in the font as they are found, the
+/// 			decimal ones with a multiplication by the reciprocal of 10 (on the MPY32 hardware
+/// 			multiplier), so it is much faster than _printf().<br />
+/// 			<i>fmt</i> is the minimum number of digits, zeros are shown up to it and blanks
+/// 			further left. A fixed-point number with <i>d</i> decimals takes <i>d</i> + 1 digits,
+/// 			the caller lights the decimal point symbol. With #NUM_SIGNED the first segment is
+/// 			the sign; <i>n</i> is unsigned otherwise. Only the lowest digits of a number wider
+/// 			than <i>segments</i> are shown, over the sign like _sprintf() does.
+/// Example:
+/// @code
+/// 	// shows "0905" on the first line, like _printf(0, LCD_SEG_L1_3_0, "%04u", 905)
+/// 	display_number(0, LCD_SEG_L1_3_0, 905, 4, SEG_SET);
+/// 
+/// 	// shows "- 48", like "%3s"
+/// 	display_number(0, LCD_SEG_L1_3_0, -48, NUM_SIGNED, SEG_SET);
+/// 
+/// 	// shows " 5" then "05", "%2u" and "%02u"
+/// 	display_number(0, LCD_SEG_L1_1_0, 5, 1, SEG_SET);
+/// 	display_number(0, LCD_SEG_L1_1_0, 5, 2, SEG_SET);
+/// 
+/// 	// shows "00FF", like "%04x"
+/// 	display_number(0, LCD_SEG_L1_3_0, 0xff, NUM_HEX | 4, SEG_SET);
+/// 
+/// 	// shows "-0.5" in 3 segments, a fixed-point number with 1 decimal
+/// 	display_number(0, LCD_SEG_L1_3_1, -5, NUM_SIGNED | 2, SEG_SET);
+/// 	display_symbol(0, LCD_SEG_L1_DP1, SEG_ON);
+/// @endcode
+/// @see	display_bcd(), _sprintf()
+//* ************************************************************************************************
+void display_number(
+	uint8_t scr_nr,							/**< The virtual screen number where to display */
+	enum display_segment_array segments,	/**< A segment array */
+	int16_t n,								/**< The number */
+	uint8_t fmt,							/**< Minimum number of digits, or-ed with #display_numfmt flags */
+	enum display_segstate state				/**< A bitfield with state operations to be performed on the segment */
+);
+
 //* ************************************************************************************************
 /// @brief		Displays a symbol
 /// @details	Changes the <i>state</i> of the segment of <i>symbol</i>. 
@@ -126,22 +126,22 @@ void infomem_insert_delete_modify(uint16_t *start, uint16_t *data, uint8_t del_c
 
 	//find first modified flash segment
 	if ((mod_count > 0) && (mod_addr[0] < start)) {
-		segment_first = (uint16_t *)((uint16_t) mod_addr[0] & ~(INFOMEM_SEGMENT_SIZE - 1));
+		segment_first = (uint16_t *)((uintptr_t) mod_addr[0] & ~(INFOMEM_SEGMENT_SIZE - 1));
 	} else {
-		segment_first = (uint16_t *)((uint16_t) start & ~(INFOMEM_SEGMENT_SIZE - 1));
+		segment_first = (uint16_t *)((uintptr_t) start & ~(INFOMEM_SEGMENT_SIZE - 1));
 	}
 
 	//find last modified flash segment
 	if (more == 0) {
 		if ((mod_count > 0) && (mod_addr[mod_count - 1] >= start + ins_count)) {
-			segment_last = (uint16_t *)((uint16_t) mod_addr[mod_count - 1] & ~(INFOMEM_SEGMENT_SIZE - 1));
+			segment_last = (uint16_t *)((uintptr_t) mod_addr[mod_count - 1] & ~(INFOMEM_SEGMENT_SIZE - 1));
 		} else {
-			segment_last = (uint16_t *)((uint16_t)(start + ins_count - 1) & ~(INFOMEM_SEGMENT_SIZE - 1));
+			segment_last = (uint16_t *)((uintptr_t)(start + ins_count - 1) & ~(INFOMEM_SEGMENT_SIZE - 1));
 		}
 	} else if (more > 0) {
-		segment_last = (uint16_t *)((uint16_t)(free_start + more - 1) & ~(INFOMEM_SEGMENT_SIZE - 1));
+		segment_last = (uint16_t *)((uintptr_t)(free_start + more - 1) & ~(INFOMEM_SEGMENT_SIZE - 1));
 	} else { //more<0
-		segment_last = (uint16_t *)((uint16_t)(free_start - 1) & ~(INFOMEM_SEGMENT_SIZE - 1));
+		segment_last = (uint16_t *)((uintptr_t)(free_start - 1) & ~(INFOMEM_SEGMENT_SIZE - 1));
 	}
 
 	//we need buffer memory to store a flash page while it is erased and rewritten
@@ -157,7 +157,7 @@ void infomem_insert_delete_modify(uint16_t *start, uint16_t *data, uint8_t del_c
 
 		//while we have not processed all modified flash segments
 		while (segment_first <= segment_last) {
-			data_offset = ((uint16_t)start - (uint16_t)segment_last) / 2;
+			data_offset = ((uintptr_t)start - (uintptr_t)segment_last) / 2;
 
 			for (i = INFOMEM_SEGMENT_WORDS - 1; i >= 0; i--) {
 				//data we need to preserve
@@ -203,7 +203,7 @@ void infomem_insert_delete_modify(uint16_t *start, uint16_t *data, uint8_t del_c
 		next_mod = 0;
 
 		while (segment_first <= segment_last) {
-			data_offset = ((uint16_t)start - (uint16_t)segment_first) / 2;
+			data_offset = ((uintptr_t)start - (uintptr_t)segment_first) / 2;
 
 			for (i = 0; i < INFOMEM_SEGMENT_WORDS; i++) {
 				//data we need to preserve
@@ -290,7 +290,7 @@ int16_t infomem_ready()
 	}
 
 	//if address is already set and in right range, look if it is correct, otherwise reset it
-	if ((((uint16_t)(sInfomem.startaddr)) >= INFOMEM_START) && (((uint16_t)(sInfomem.startaddr)) < (INFOMEM_START + 4 * INFOMEM_SEGMENT_SIZE))) {
+	if ((((uintptr_t)(sInfomem.startaddr)) >= INFOMEM_START) && (((uintptr_t)(sInfomem.startaddr)) < (INFOMEM_START + 4 * INFOMEM_SEGMENT_SIZE))) {
 		if (*(sInfomem.startaddr) == INFOMEM_IDENTIFIER) {
 			found_beg = 1;
 		} else {
@@ -321,7 +321,7 @@ int16_t infomem_ready()
 	sInfomem.maxsize = ((uint8_t *)(sInfomem.startaddr))[3];
 
 	//check size and maxsize for plausibility
-	if (sInfomem.size > sInfomem.maxsize || sInfomem.maxsize > (INFOMEM_START + 4 * INFOMEM_SEGMENT_SIZE - 6 - (uint16_t)sInfomem.startaddr) / 2) {
+	if (sInfomem.size > sInfomem.maxsize || sInfomem.maxsize > (INFOMEM_START + 4 * INFOMEM_SEGMENT_SIZE - 6 - (uintptr_t)sInfomem.startaddr) / 2) {
 		return -3;
 	}
 
@@ -353,14 +353,14 @@ int16_t infomem_ready()
 // *************************************************************************************************
 // @fn          infomem_init
 // @brief       write infomem data structure
-// @param		uint16_t	start		(word) address of first word of used memory
-//				uint16_t	end			(word) address of first word of NOT used memory
+// @param		uintptr_t	start		(word) address of first word of used memory
+//				uintptr_t	end			(word) address of first word of NOT used memory
 // @return		-1 infomem already present
 //				-2 addresses not word addresses or out of range
 //				-3 memory not empty
 //				>0 new maximum size
 // *************************************************************************************************
-int16_t infomem_init(uint16_t start, uint16_t end)
+int16_t infomem_init(uintptr_t start, uintptr_t end)
 {
 	if (sInfomem.sane == INFOMEM_SANE) {
 		return -1;
@@ -426,8 +426,8 @@ int16_t infomem_space()
 // *************************************************************************************************
 // @fn          infomem_relocate
 // @brief       change start and end address of data storage (can change size)
-// @param		uint16_t	start		(word) address of first word of used memory
-//				uint16_t	end			(word) address of first word of NOT used memory
+// @param		uintptr_t	start		(word) address of first word of used memory
+//				uintptr_t	end			(word) address of first word of NOT used memory
 // @return		-1 data structure error or memory not initialized
 //				-2 temporary error (try again later)
 //				-3 address not word addresses
@@ -435,7 +435,7 @@ int16_t infomem_space()
 //				-5 new space too small
 //				>0 new maximum size
 // *************************************************************************************************
-int16_t infomem_relocate(uint16_t start, uint16_t end)
+int16_t infomem_relocate(uintptr_t start, uintptr_t end)
 {
 	//check if we really have word addresses
 	if ((start & 0x1) || (end & 0x1)) {
@@ -4,7 +4,7 @@
  * use as desired but do not remove this notice
  */
 
-#include "project.h"
+#include <core/openchronos.h>
 
 #ifndef INFOMEM_H_
 #define INFOMEM_H_
@@ -34,11 +34,11 @@
 //check if infomem is initialized and in sane state, return amount of data present
 extern int16_t infomem_ready();
 //write infomem data structure
-extern int16_t infomem_init(uint16_t start, uint16_t end);
+extern int16_t infomem_init(uintptr_t start, uintptr_t end);
 //return amount of free space
 extern int16_t infomem_space();
 //change start and end address of data storage (can change size)
-extern int16_t infomem_relocate(uint16_t start, uint16_t end);
+extern int16_t infomem_relocate(uintptr_t start, uintptr_t end);
 //delete complete data storage (only managed space)
 extern int16_t infomem_delete_all(void);
 
@@ -71,11 +71,14 @@ struct infomem {
 #define INFOMEM_TERMINATOR 0xdaf4
 #define INFOMEM_SANE 0xda
 
+//the host simulation build puts the information memory elsewhere
+#ifndef INFOMEM_START
 #define INFOMEM_START 0x1800
-#define INFOMEM_D 0x1800
-#define INFOMEM_C 0x1880
-#define INFOMEM_B 0x1900
-#define INFOMEM_A 0x1980
+#endif
+#define INFOMEM_D (INFOMEM_START + 0x000)
+#define INFOMEM_C (INFOMEM_START + 0x080)
+#define INFOMEM_B (INFOMEM_START + 0x100)
+#define INFOMEM_A (INFOMEM_START + 0x180)
 #define INFOMEM_SEGMENT_SIZE 128
 #define INFOMEM_SEGMENT_WORDS INFOMEM_SEGMENT_SIZE/2
 #define INFOMEM_ERASED_WORD 0xFFFF
@@ -19,6 +19,9 @@
 
 
 #include <core/openchronos.h>
+#include <core/profile.h>
+#include <core/stackmon.h>
+#include <core/wakestat.h>
 
 /* drivers */
 #include "ports.h"
@@ -38,6 +41,26 @@
 
 #define BIT_IS_SET(F, B) (((F) | (B)) == (F))
 
+/* TA0 ticks in 1/20 second, the unit of the press times */
+#define PORTS_TICKS_20HZ			(16384 / 20)
+
+/* long presses are reported while the buttons are still held, by a
+  one-shot software timer armed when a button is pressed */
+static struct timer0_swtimer ports_long_timer;
+
+/* TA0R when the last button was pressed */
+static uint16_t ports_press_stamp;
+
+/* the long press of the held buttons was already reported */
+static uint8_t ports_long_done;
+
+/* software timer callback, from interrupt context */
+static void ports_long_press(void)
+{
+	ports_pressed_btns |= (P2IES & ALL_BUTTONS) << 5;
+	ports_long_done = 1;
+}
+
 void init_buttons(void)
 {
 	/* Set button ports to input */
@@ -55,6 +78,16 @@ void init_buttons(void)
 
 	/* Enable button interrupts */
 	P2IE |= ALL_BUTTONS;
+
+	/* Wake up the mainloop to handle the long press */
+	ports_long_timer.fn = ports_long_press;
+	ports_long_timer.flags |= TIMER0_SWTIMER_WAKEUP;
+}
+
+uint8_t ports_held_btns(void)
+{
+	/* held buttons wait for their falling edge */
+	return P2IES & ALL_BUTTONS;
 }
 
 /*
@@ -66,12 +99,15 @@ void init_buttons(void)
 __attribute__((interrupt(PORT2_VECTOR)))
 void PORT2_ISR(void)
 {
-	static uint16_t last_press;
+	STACK_SCOPE(PORT2_ISR);
+	PROF_SCOPE(PORT2_ISR);
 
 	/* If the interrupt is not a button press, then handle accel */
 	if ((P2IFG & ALL_BUTTONS) == 0)
 		goto accel_handler;
 
+	WAKE_STAT(WAKE_PORT2_BUTTON);
+
 	/* get mask for buttons in rising edge */
 	uint8_t rising_mask = ~P2IES & ALL_BUTTONS;
 
@@ -79,10 +115,15 @@ void PORT2_ISR(void)
 	 the ones that were just pressed */
 	uint8_t buttons = P2IFG & rising_mask;
 
-#ifdef CONFIG_TIMER_20HZ_IRQ
-	if (buttons)
-		last_press = timer0_20hz_counter;
-#endif
+	/* a button pressed while others are held joins their press, which
+	  keeps its start time and long press state */
+	if (buttons && !(P2IES & ALL_BUTTONS)) {
+		/* measure the press, and report it as long if it lasts */
+		ports_press_stamp = TA0R;
+		ports_long_done = 0;
+		timer0_swtimer_start(&ports_long_timer,
+				CONFIG_BUTTONS_LONG_PRESS_TIME * 50, 0, 0);
+	}
 
 	/* set pressed button IRQ triggers to falling edge,
 	 so we can detect when they are released */
@@ -100,17 +141,13 @@ void PORT2_ISR(void)
 	if (buttons) {
 		buttons |= P2IES;
 
-#ifdef CONFIG_TIMER_20HZ_IRQ
-		uint16_t pressed_ticks = timer0_20hz_counter - last_press;
-#else
-		/* in case timer is disabled, at least detect short presses */
-		uint16_t pressed_ticks = CONFIG_BUTTONS_SHORT_PRESS_TIME;
-#endif
+		uint16_t pressed_ticks = TA0R - ports_press_stamp;
+		timer0_swtimer_stop(&ports_long_timer);
 
-		/* check how long btn was pressed and save the event */
-		if (pressed_ticks > CONFIG_BUTTONS_LONG_PRESS_TIME)
-			ports_pressed_btns |= buttons << 5;
-		else if (pressed_ticks >= CONFIG_BUTTONS_SHORT_PRESS_TIME)
+		/* a long press was already saved, otherwise save a short
+		  one unless it was a bounce */
+		if (!ports_long_done && pressed_ticks
+				>= CONFIG_BUTTONS_SHORT_PRESS_TIME * PORTS_TICKS_20HZ)
 			ports_pressed_btns |= buttons;
 
 		/* set buttons IRQ triggers to rising edge */
@@ -126,15 +163,24 @@ accel_handler:
 	/* Check if accelerometer interrupt flag */
 	if ((P2IFG & AS_INT_PIN) == AS_INT_PIN)
 	{
+		WAKE_STAT(WAKE_PORT2_ACCEL);
 		display_chars(0, LCD_SEG_L1_2_0, "PSF", SEG_ON);
-		as_last_interrupt = 1;
+		sys_messagebus_post(SYS_MSG_AS_INT);
+
+		/* Exit from LPM3 on RETI */
+		_BIC_SR_IRQ(LPM3_bits);
 	}
 	#endif
 	
 	#ifdef CONFIG_PRESSURE_SENSOR
 	/* Check if pressure interrupt flag */
-	if ((P2IFG & PS_INT_PIN) == PS_INT_PIN)
-		ps_last_interrupt = 1;
+	if ((P2IFG & PS_INT_PIN) == PS_INT_PIN) {
+		WAKE_STAT(WAKE_PORT2_PRESSURE);
+		sys_messagebus_post(SYS_MSG_PS_INT);
+
+		/* Exit from LPM3 on RETI */
+		_BIC_SR_IRQ(LPM3_bits);
+	}
 	#endif
 
 	/* A write to the interrupt vector, automatically clears the
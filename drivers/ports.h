@@ -59,4 +59,7 @@ volatile enum ports_buttons ports_pressed_btns;
 
 void init_buttons(void);
 
+/* buttons being held down, see PORTS_BTN_*_PIN */
+uint8_t ports_held_btns(void);
+
 #endif /* __PORTS_H__ */
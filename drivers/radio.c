@@ -37,6 +37,9 @@
 
 // system
 #include <core/openchronos.h>
+#include <core/profile.h>
+#include <core/stackmon.h>
+#include <core/wakestat.h>
 
 // driver
 #include "rf1a.h"
@@ -165,6 +168,10 @@ __interrupt
 #endif
 void radio_ISR(void)
 {
+	STACK_SCOPE(radio_ISR);
+	PROF_SCOPE(radio_ISR);
+	WAKE_STAT(WAKE_RADIO);
+	
 	uint8_t rf1aivec = RF1AIV;
 
 	// Forward to SimpliciTI interrupt service routine
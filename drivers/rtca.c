@@ -18,12 +18,19 @@
     You should have received a copy of the GNU General Public License
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
-/* TODO: The RTC supports chronologic alarms, that is, one can program the
-	alarm to bell every hour, or in a specific time and day. For now only
-	basic alarm is implemented (bell at 08:30). */
+/* The RTC supports chronologic alarms, that is, one can program the
+	alarm to bell every hour, or in a specific time and day. The alarm
+	table of core/alarms.c programs its nearest alarm with
+	rtca_set_alarm_dow(). */
 
 #include "rtca.h"
 #include "config/rtca_now.h"
+#include "timer.h"
+
+#include <core/alarms.h>
+#include <core/profile.h>
+#include <core/stackmon.h>
+#include <core/wakestat.h>
 
 #ifdef CONFIG_RTC_DST
 #include "rtc_dst.h"
@@ -40,38 +47,156 @@
 #define BASE_YEAR 1984 /* not a leap year, so no need to add 1 */
 #define LEAPS_SINCE_YEAR(Y) (((Y) - BASE_YEAR) + ((Y) - BASE_YEAR) / 4);
 
+/* days in four years, the first one leap (2000 to 2099) */
+#define DAYS_4_YEARS (4 * 365 + 1)
+
+/* days before each month in a non leap year */
+static const uint16_t rtca_yday[12] = {
+	0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334
+};
+
+#ifdef CONFIG_RTC_BCD
+#define rtca_get_year()		(rtca_bin(RTCYEARH) * 100 + rtca_bin(RTCYEARL))
+#else
+#define rtca_get_year()		(RTCYEARL | (RTCYEARH << 8))
+#endif
+
+/* writes the year register, the BCD format only counts 2000 to 2099 like
+  the epoch conversions */
+static void rtca_put_year(uint16_t year)
+{
+#ifdef CONFIG_RTC_BCD
+	RTCYEARL = rtca_bcd_of(year - 2000);
+	RTCYEARH = 0x20;
+#else
+	RTCYEARL = year & 0xff;
+	RTCYEARH = year >> 8;
+#endif
+}
+
+/* refreshes rtca_bcd from the RTC registers after they were written */
+static void rtca_update_bcd(void)
+{
+#ifdef CONFIG_RTC_BCD
+	rtca_bcd.year = RTCYEARL | (RTCYEARH << 8);
+	rtca_bcd.mon = RTCMON;
+	rtca_bcd.day = RTCDAY;
+	rtca_bcd.hour = RTCHOUR;
+	rtca_bcd.min = RTCMIN;
+#endif
+}
+
+/* caches a calendar register in rtca_time, and in rtca_bcd as it is */
+#ifdef CONFIG_RTC_BCD
+#define rtca_cache(field, reg)	(rtca_time.field = rtca_bin(rtca_bcd.field = (reg)))
+#else
+#define rtca_cache(field, reg)	(rtca_time.field = (reg))
+#endif
+
+uint8_t rtca_bcd_of(uint8_t n)
+{
+	uint8_t bcd = 0;
+
+	for (; n >= 10; n -= 10)
+		bcd += 0x10;
+
+	return bcd | n;
+}
+
+/* sum of the steps of rtca_now_ms() when the time or date was set */
+static uint32_t rtca_ms_steps;
+
+/* rtca_time.epoch at midnight, and the day it was computed for */
+static uint32_t rtca_midnight;
+static uint8_t rtca_midnight_day;
+
+/* seconds since 1970-01-01 of the given time of the current day, only the
+  time of the day is computed unless the day changed. interrupts must be
+  disabled */
+static uint32_t rtca_epoch_of(uint8_t hour, uint8_t min, uint8_t sec)
+{
+	uint8_t day = RTCDAY;
+
+	if (day != rtca_midnight_day) {
+		rtca_midnight_day = day;
+		rtca_midnight = rtca_mktime(rtca_get_year(), rtca_get(RTCMON),
+					    rtca_get(day), 0, 0, 0);
+	}
+
+	return rtca_midnight + (uint32_t)((uint16_t)hour * 60 + min) * 60 + sec;
+}
+
+uint32_t rtca_epoch(void)
+{
+	uint16_t sr = __read_status_register();
+	uint8_t hour, min, sec;
+	uint32_t epoch;
+
+	__dint();
+
+	/* read again if the RTC counted between two registers */
+	do {
+		sec = RTCSEC;
+		min = RTCMIN;
+		hour = RTCHOUR;
+	} while (sec != RTCSEC);
+
+	epoch = rtca_epoch_of(rtca_get(hour), rtca_get(min), rtca_get(sec));
+
+	__write_status_register(sr);
+
+	return epoch;
+}
+
+/* refreshes rtca_time.epoch from the RTC registers, the RTC interrupt
+  also writes it */
+static void rtca_update_epoch(void)
+{
+	uint16_t sr = __read_status_register();
+
+	__dint();
+	rtca_time.epoch = rtca_epoch();
+	__write_status_register(sr);
+}
+
 void rtca_init(void)
 {
 
 	rtca_time.year = COMPILE_YEAR;
 	rtca_time.mon = COMPILE_MON;
 	rtca_time.day = COMPILE_DAY;
-	rtca_time.dow = COMPILE_DOW;
+	rtca_time.dow = COMPILE_DOW % 7;	/* date +%u gives 7 on sunday */
 	rtca_time.hour = COMPILE_HOUR;
 	rtca_time.min = COMPILE_MIN;
 	rtca_time.sec = 59;
 
 #ifdef CONFIG_RTC_IRQ
 	/* Enable calendar mode (date/time registers are automatically reset)
-	and enable read ready interrupts
 	and set time event interrupts at each minute
-	also enable alarm interrupts */
-	RTCCTL01 |= RTCMODE | RTCRDYIE | RTCAIE;
+	also enable alarm interrupts. Read ready interrupts (each second)
+	are only enabled while someone listens, see rtca_set_events() */
+	RTCCTL01 |= RTCMODE | RTCAIE;
+#ifdef CONFIG_RTC_BCD
+	/* the format is not converted, set it before writing the registers */
+	RTCCTL01 |= RTCBCD;
+#endif
 
-	RTCSEC = rtca_time.sec;
-	RTCMIN = rtca_time.min;
-	RTCHOUR = rtca_time.hour;
-	RTCDAY = rtca_time.day;
+	RTCSEC = rtca_put(rtca_time.sec);
+	RTCMIN = rtca_put(rtca_time.min);
+	RTCHOUR = rtca_put(rtca_time.hour);
+	RTCDAY = rtca_put(rtca_time.day);
 	RTCDOW = rtca_time.dow;
-	RTCMON = rtca_time.mon;
-	RTCYEARL = rtca_time.year & 0xff;
-	RTCYEARH = rtca_time.year >> 8;
+	RTCMON = rtca_put(rtca_time.mon);
+	rtca_put_year(rtca_time.year);
+	rtca_update_bcd();
 
 	/* Enable the RTC */
 	rtca_start();
 
 	/* Enable minutes interrupts */
 	RTCCTL01 |= RTCTEVIE;
+
+	rtca_update_epoch();
 #endif
 
 #ifdef CONFIG_RTC_DST
@@ -81,6 +206,23 @@ void rtca_init(void)
 
 }
 
+void rtca_set_events(enum rtca_tevent events)
+{
+#ifdef CONFIG_RTC_IRQ
+	/* minute interrupts stay always enabled, they keep the time cache
+	  and DST updated. The alarm interrupt is handled by
+	  rtca_enable_alarm() and rtca_disable_alarm() */
+	if (events & RTCA_EV_SECOND) {
+		/* do not fire right away from a stale flag */
+		if (!(RTCCTL01 & RTCRDYIE)) {
+			RTCCTL01 &= ~RTCRDYIFG;
+			RTCCTL01 |= RTCRDYIE;
+		}
+	} else
+		RTCCTL01 &= ~RTCRDYIE;
+#endif
+}
+
 /* returns number of days for a given month */
 uint8_t rtca_get_max_days(uint8_t month, uint16_t year)
 {
@@ -110,30 +252,162 @@ uint8_t rtca_get_max_days(uint8_t month, uint16_t year)
 	return 0;
 }
 
+/* days since 2000-01-01 */
+uint16_t rtca_days(uint16_t year, uint8_t mon, uint8_t day)
+{
+	uint8_t y = year - 2000;
+
+	/* the leap days of the previous years, 2000 was the first one */
+	uint16_t days = y * 365 + ((y + 3) >> 2) + rtca_yday[mon - 1] + day - 1;
+
+	if (mon > 2 && !(y & 3))
+		days++;
+
+	return days;
+}
+
+/* seconds since 1970-01-01 */
+uint32_t rtca_mktime(uint16_t year, uint8_t mon, uint8_t day,
+		     uint8_t hour, uint8_t min, uint8_t sec)
+{
+	return RTCA_EPOCH_2000 + rtca_days(year, mon, day) * 86400UL
+		+ (uint32_t)((uint16_t)hour * 60 + min) * 60 + sec;
+}
+
+/* calendar time of seconds since 1970-01-01. The quotients are estimated
+  by 16x16bit multiplications, a bit low, and corrected by subtractions */
+void rtca_from_epoch(uint32_t epoch, struct rtca_tm *tm)
+{
+	uint32_t secs = epoch - RTCA_EPOCH_2000;
+	uint32_t h = secs >> 7;
+	uint16_t days, rem, sod4, minutes;
+	uint8_t cycles, years, mon, leap;
+
+	/* 86400 = 128 * 675, the estimate is at most 3 days low */
+	days = ((h >> 9) * 49710UL) >> 16;
+	for (rem = h - days * 675UL; rem >= 675; rem -= 675)
+		days++;
+
+	/* a quarter of the second of the day fits in 16bit, / 15 and / 60
+	  as * 0x8889 >> 19 and >> 21 are exact */
+	sod4 = (rem << 5) | ((secs & 127) >> 2);
+	minutes = (sod4 * 0x8889UL) >> 19;
+	tm->sec = ((sod4 - minutes * 15) << 2) | (secs & 3);
+	tm->hour = (minutes * 0x8889UL) >> 21;
+	tm->min = minutes - tm->hour * 60;
+
+	/* 2000-01-01 was a saturday, / 7 as * 0x4925 >> 17 is exact for
+	  less than 36600 days */
+	rem = days + 6;
+	tm->dow = rem - ((rem * 0x4925UL) >> 17) * 7;
+
+	/* four years cycles start with a leap year, the estimate is at most
+	  one cycle low */
+	cycles = (days * 1435UL) >> 21;
+	days -= cycles * DAYS_4_YEARS;
+	if (days >= DAYS_4_YEARS) {
+		days -= DAYS_4_YEARS;
+		cycles++;
+	}
+	years = cycles << 2;
+
+	leap = days < 366;
+	if (!leap) {
+		days -= 366;
+		for (years++; days >= 365; years++)
+			days -= 365;
+	}
+
+	tm->year = 2000 + years;
+
+	/* leap years have february 29th after day 58 */
+	if (leap && days >= 59) {
+		if (days == 59) {
+			tm->mon = 2;
+			tm->day = 29;
+			return;
+		}
+		days--;
+	}
+
+	/* months are 28 to 31 days long, days / 32 is the month or the one
+	  before */
+	mon = days >> 5;
+	if (mon < 11 && days >= rtca_yday[mon + 1])
+		mon++;
+
+	tm->mon = mon + 1;
+	tm->day = days - rtca_yday[mon] + 1;
+}
+
+uint32_t rtca_mono_ms(void)
+{
+	return rtca_now_ms() - rtca_ms_steps;
+}
+
+uint32_t rtca_now_ms(void)
+{
+	uint16_t sr = __read_status_register();
+	uint8_t hour, min, sec, ps1, ps0;
+	uint32_t now;
+
+	__dint();
+
+	/* the prescalers keep counting, read again if a carry happened
+	  between two registers */
+	do {
+		ps1 = RTCPS1;
+		ps0 = RTCPS0;
+		sec = RTCSEC;
+		min = RTCMIN;
+		hour = RTCHOUR;
+	} while (ps1 != RTCPS1 || sec != RTCSEC);
+
+	/* RT0PS counts ACLK and RT1PS its overflows (128Hz), 1/32768s to
+	  ms is * 1000 / 32768 = * 125 / 4096 */
+	now = rtca_epoch_of(rtca_get(hour), rtca_get(min), rtca_get(sec)) * 1000
+		+ ((((uint16_t)(ps1 & 0x7f) << 8 | ps0) * 125UL) >> 12);
+
+	__write_status_register(sr);
+
+	return now;
+}
+
 void rtca_set_time()
 {
+	uint32_t before = rtca_now_ms();
+
 	/* Stop RTC timekeeping for a while */
 	rtca_stop();
 
 	/* update RTC registers */
-	RTCSEC = rtca_time.sec;
-	RTCMIN = rtca_time.min;
-	RTCHOUR = rtca_time.hour;
+	RTCSEC = rtca_put(rtca_time.sec);
+	RTCMIN = rtca_put(rtca_time.min);
+	RTCHOUR = rtca_put(rtca_time.hour);
+	rtca_update_bcd();
 
 	/* Resume RTC time keeping */
 	rtca_start();
+
+	rtca_update_epoch();
+	rtca_ms_steps += rtca_now_ms() - before;
+
+#ifdef CONFIG_RTC_IRQ
+	/* the programmed alarm may not be the nearest one anymore */
+	sys_workqueue_add(alarms_program);
+#endif
 }
 
 void rtca_get_alarm(uint8_t *hour, uint8_t *min)
 {
-	*hour = RTCAHOUR & 0x1F;
-	*min  = RTCAMIN  & 0x3F;
+	*hour = rtca_get(RTCAHOUR & 0x7F);
+	*min  = rtca_get(RTCAMIN & 0x7F);
 }
 
 void rtca_set_alarm(uint8_t hour, uint8_t min)
 {
-	RTCAHOUR = (RTCAHOUR & 0x80) | hour;
-	RTCAMIN  = (RTCAMIN & 0x80) | min;
+	RTCAHOUR = (RTCAHOUR & 0x80) | rtca_put(hour);
+	RTCAMIN  = (RTCAMIN & 0x80) | rtca_put(min);
 }
 
 void rtca_enable_alarm()
@@ -144,15 +418,29 @@ void rtca_enable_alarm()
 	RTCCTL01 |= RTCAIE;
 }
 
+void rtca_set_alarm_dow(uint8_t dow, uint8_t hour, uint8_t min)
+{
+	/* no interrupt from a half programmed alarm */
+	RTCCTL01 &= ~RTCAIE;
+	RTCAMIN  = 0x80 | rtca_put(min);
+	RTCAHOUR = 0x80 | rtca_put(hour);
+	RTCADOW  = 0x80 | dow;
+	RTCADAY  = 0;
+	RTCCTL01 &= ~RTCAIFG;
+	RTCCTL01 |= RTCAIE;
+}
+
 void rtca_disable_alarm()
 {
 	RTCAHOUR &= 0x7F;
 	RTCAMIN  &= 0x7F;
+	RTCADOW  &= 0x7F;
 	RTCCTL01 &= ~RTCAIE;
 }
 
 void rtca_set_date()
 {
+	uint32_t before = rtca_now_ms();
 	uint8_t dow;
 
 	/* Stop RTC timekeeping for a while */
@@ -200,28 +488,68 @@ void rtca_set_date()
 	dow = dow % 7;
 
 	/* update RTC registers and local cache */
-	RTCDAY = rtca_time.day;
+	RTCDAY = rtca_put(rtca_time.day);
 	RTCDOW = (rtca_time.dow = dow);
-	RTCMON = rtca_time.mon;
-	RTCYEARL = rtca_time.year & 0xff;
-	RTCYEARH = rtca_time.year >> 8;
+	RTCMON = rtca_put(rtca_time.mon);
+	rtca_put_year(rtca_time.year);
+	rtca_update_bcd();
 
 	/* Resume RTC time keeping */
 	rtca_start();
 
+	/* the day of the month may be the same in another month */
+	rtca_midnight_day = 0;
+	rtca_update_epoch();
+	rtca_ms_steps += rtca_now_ms() - before;
+
+#ifdef CONFIG_RTC_IRQ
+	/* the programmed alarm may not be the nearest one anymore */
+	sys_workqueue_add(alarms_program);
+#endif
+
 #ifdef CONFIG_RTC_DST
 	/* calculate new DST switch dates */
 	rtc_dst_calculate_dates(rtca_time.year, rtca_time.mon, rtca_time.day, rtca_time.hour);
 #endif
 }
+#ifdef CONFIG_RTC_DST
+/* DST work is too heavy for the interrupt handler, it is deferred to the
+  mainloop. Time changes are announced as an hour event */
+static void rtca_dst_hourly_work(void)
+{
+	uint8_t hour = rtca_time.hour;
+
+	rtc_dst_hourly_update();
+
+	if (rtca_time.hour != hour) {
+		__disable_interrupt();
+		sys_messagebus_post(SYS_MSG_RTC_HOUR);
+		__enable_interrupt();
+	}
+}
+
+static void rtca_dst_yearly_work(void)
+{
+	/* calculate new DST switch dates */
+	rtc_dst_calculate_dates(rtca_time.year, rtca_time.mon, rtca_time.day, rtca_time.hour);
+}
+#endif
+
 __attribute__((interrupt(RTC_A_VECTOR)))
 void RTC_A_ISR(void)
 {
+	STACK_SCOPE(RTC_A_ISR);
+	PROF_SCOPE(RTC_A_ISR);
+
 	/* the IV is cleared after a read, so we store it */
 	uint16_t iv = RTCIV;
 
 	/* copy register values */
-	rtca_time.sec = RTCSEC;
+	rtca_time.sec = rtca_get(RTCSEC);
+	rtca_update_epoch();
+
+	/* software timers waiting in their slack ride on this interrupt */
+	uint8_t wakeup = timer0_swtimer_service();
 
 	/* count system time */
 	rtca_time.sys++;
@@ -230,11 +558,13 @@ void RTC_A_ISR(void)
 
 	/* second event (from the read ready interrupt flag) */
 	if (iv == RTCIV_RTCRDYIFG) {
+		WAKE_STAT(WAKE_RTC_SECOND);
 		ev = RTCA_EV_SECOND;
 		goto finish;
 	}
 
 	if (iv == RTCIV_RTCAIFG) {
+		WAKE_STAT(WAKE_RTC_ALARM);
 		ev = RTCA_EV_ALARM;
 		goto finish;
 	}
@@ -243,48 +573,56 @@ void RTC_A_ISR(void)
 		if (iv != RTCIV_RTCTEVIFG)	/* Minute changed! */
 			goto finish;
 
+		WAKE_STAT(WAKE_RTC_MINUTE);
 
 		ev |= RTCA_EV_MINUTE;
-		rtca_time.min = RTCMIN;
+		rtca_cache(min, RTCMIN);
 
 		if (rtca_time.min != 0)		/* Hour changed */
 			goto finish;
 
 		ev |= RTCA_EV_HOUR;
-		rtca_time.hour = RTCHOUR;
+		rtca_cache(hour, RTCHOUR);
 
 #ifdef CONFIG_RTC_DST
-		rtc_dst_hourly_update();
+		sys_workqueue_add(rtca_dst_hourly_work);
 #endif
 
 		if (rtca_time.hour != 0)	/* Day changed */
 			goto finish;
 
 		ev |= RTCA_EV_DAY;
-		rtca_time.day = RTCDAY;
+		rtca_cache(day, RTCDAY);
 		rtca_time.dow = RTCDOW;
 
 		if (rtca_time.day != 1)		/* Month changed */
 			goto finish;
 
 		ev |= RTCA_EV_MONTH;
-		rtca_time.mon = RTCMON;
+		rtca_cache(mon, RTCMON);
 
 		if (rtca_time.mon != 1)		/* Year changed */
 			goto finish;
 
 		ev |= RTCA_EV_YEAR;
-		rtca_time.year = RTCYEARL | (RTCYEARH << 8);
+		rtca_time.year = rtca_get_year();
+#ifdef CONFIG_RTC_BCD
+		rtca_bcd.year = RTCYEARL | (RTCYEARH << 8);
+#endif
 #ifdef CONFIG_RTC_DST
-		/* calculate new DST switch dates */
-		rtc_dst_calculate_dates(rtca_time.year, rtca_time.mon, rtca_time.day, rtca_time.hour);
+		sys_workqueue_add(rtca_dst_yearly_work);
 #endif
 	}
 
 finish:
-	/* append events, since ISR could be triggered
-	 multipe times until rtca_last_event gets parsed */
-	rtca_last_event |= ev;
+	/* nothing to deliver, e.g. from a prescaler interrupt */
+	if (!ev && !wakeup)
+		return;
+
+	/* queue events, the message bus counts them if the ISR is
+	 triggered multiple times until they get delivered */
+	if (ev)
+		sys_messagebus_post((enum sys_message)ev);
 
 	/* exit from LPM3, give execution back to mainloop */
 	_BIC_SR_IRQ(LPM3_bits);
@@ -45,8 +45,26 @@ static char const * const rtca_dow_str[] = {
 #endif
 };
 
+/* Seconds from 1970-01-01 to 2000-01-01 */
+#define RTCA_EPOCH_2000	946684800UL
+
+/* calendar time, see rtca_from_epoch() */
+struct rtca_tm {
+	uint16_t year;
+	uint8_t mon;    /* 1 to 12 */
+	uint8_t day;    /* 1 to 31 */
+	uint8_t dow;    /* 0 is sunday */
+	uint8_t hour;
+	uint8_t min;
+	uint8_t sec;
+};
+
 struct {
 	uint32_t sys;   /* system time: number of seconds since power on */
+	uint32_t epoch; /* seconds since 1970-01-01, refreshed by every RTC
+	                  interrupt. It is exact in SYS_MSG_RTC_SECOND listeners,
+	                  otherwise up to 59s behind, see rtca_epoch(). It is
+	                  not atomic, read it from a message bus listener */
 	uint16_t year;  /* cache of RTC year register */
 	uint8_t mon;    /* cache of RTC month register */
 	uint8_t day;    /* cache of RTC day register */
@@ -56,6 +74,37 @@ struct {
 	uint8_t sec;    /* cache of RTC seconds register */
 } rtca_time;
 
+#ifdef CONFIG_RTC_BCD
+/* the calendar registers in BCD, kept by the RTC interrupt like rtca_time.
+  The clock shows them with display_bcd(), without any division */
+struct {
+	uint16_t year;  /* 0x2013 for 2013 */
+	uint8_t mon;
+	uint8_t day;
+	uint8_t hour;
+	uint8_t min;
+} rtca_bcd;
+#endif
+
+/* BCD to binary, the multiplication is made of shifts */
+static inline uint8_t rtca_bin(uint8_t bcd)
+{
+	return (bcd >> 4) * 10 + (bcd & 0x0f);
+}
+
+/* binary (0 to 99) to BCD, by subtractions */
+uint8_t rtca_bcd_of(uint8_t n);
+
+/* reads and writes the calendar registers in binary, whatever the
+  CONFIG_RTC_BCD format */
+#ifdef CONFIG_RTC_BCD
+#define rtca_get(reg)		rtca_bin(reg)
+#define rtca_put(n)		rtca_bcd_of(n)
+#else
+#define rtca_get(reg)		(reg)
+#define rtca_put(n)		(n)
+#endif
+
 #define rtca_stop()		(RTCCTL01 |=  RTCHOLD)
 #define rtca_start()		(RTCCTL01 &= ~RTCHOLD)
 
@@ -65,6 +114,27 @@ void rtca_init(void);
 
 uint8_t rtca_get_max_days(uint8_t month, uint16_t year);
 
+/* epoch and calendar conversions in constant time, for years 2000 to 2099.
+  They use no division, see "sim -C" for their check */
+uint16_t rtca_days(uint16_t year, uint8_t mon, uint8_t day);
+uint32_t rtca_mktime(uint16_t year, uint8_t mon, uint8_t day,
+		     uint8_t hour, uint8_t min, uint8_t sec);
+void rtca_from_epoch(uint32_t epoch, struct rtca_tm *tm);
+
+/* seconds since 1970-01-01 of the RTC time, read from the RTC registers
+  whether second interrupts are armed or not */
+uint32_t rtca_epoch(void);
+
+/* milliseconds since 1970-01-01 of the RTC time, modulo 2^32 (it wraps
+  every 49 days, use the difference of two timestamps). Read from the RTC
+  registers and prescalers, without waiting for an interrupt */
+uint32_t rtca_now_ms(void);
+
+/* milliseconds like rtca_now_ms(), without the steps of rtca_set_time()
+  and rtca_set_date(): it only moves forward with the RTC, for measuring
+  durations across clock edits and DST changes */
+uint32_t rtca_mono_ms(void);
+
 void rtca_set_time();
 void rtca_set_date();
 
@@ -72,9 +142,13 @@ void rtca_get_alarm(uint8_t *hour, uint8_t *min);
 void rtca_set_alarm(uint8_t hour, uint8_t min);
 
 void rtca_enable_alarm();
+/* programs and enables an alarm on a day of week (0 is sunday), hour
+  and minute */
+void rtca_set_alarm_dow(uint8_t dow, uint8_t hour, uint8_t min);
 void rtca_disable_alarm();
 
-/* exclusive use by openchronos system */
-volatile enum rtca_tevent rtca_last_event;
+/* arms the second interrupts only if RTCA_EV_SECOND is in events, the
+  other events are always generated. exclusive use by openchronos system */
+void rtca_set_events(enum rtca_tevent events);
 
 #endif /* __RTCA_H__ */
@@ -52,11 +52,15 @@
 
 #include "timer.h"
 
+#include <core/profile.h>
+#include <core/stackmon.h>
+#include <core/wakestat.h>
+
 /* HARDWARE TIMER ASSIGNMENT:
 	 TA0CCR0: 20Hz timer
-	 TA0CCR1: Unused
-	 TA0CCR2: callback timer (for buzzer)
-	 TA0CCR3: programable timer
+	 TA0CCR1: software timers (programable timer, callback timer)
+	 TA0CCR2: Unused
+	 TA0CCR3: Unused
 	 TA0CCR4: delay timer
 	OVERFLOW: 0.244Hz timer ~ 4.1ms */
 
@@ -67,34 +71,78 @@
 #define TIMER0_TICKS_FROM_MS(T) ((((uint32_t)TIMER0_FREQ) * (uint32_t)T) \
                                / ((uint32_t)1000))
 
+/* software timers are due when the deadline is at most this many ticks
+  away, CCR1 could miss a deadline set closer than that to TA0R */
+#define TIMER0_SWTIMER_MARGIN 2
+
+/* the timer lists can be changed from interrupts (callbacks) */
+#define TIMER0_LOCK(sr) do { sr = __read_status_register(); __dint(); } while (0)
+#define TIMER0_UNLOCK(sr) __write_status_register(sr)
+
 static volatile uint8_t delay_finished;
 
 /* 20hz timer */
 static uint16_t timer0_20hz_ticks;
 
+/* events someone is listening to, see timer0_set_events() */
+static enum timer0_event timer0_events;
+
+/* software timers sorted by deadline, the first one is programmed in CCR1 */
+static struct timer0_swtimer *timer0_swtimers;
+
 /* programable timer */
-static uint16_t timer0_prog_ticks;
+static struct timer0_swtimer timer0_prog_timer;
 
-static void (*delay_callback)(void) = NULL;
+/* callback timer */
+static struct timer0_swtimer timer0_callback_timer;
 
 void timer0_init(void)
 {
-#ifdef CONFIG_TIMER_4S_IRQ
-	/* Enable overflow interrupts */
-	TA0CTL |= TAIE;
-#endif
-
 	/* select external 32kHz source, /2 divider, continous mode */
 	TA0CTL |= TASSEL__ACLK | ID__2 | MC__CONTINOUS;
 
-#ifdef CONFIG_TIMER_20HZ_IRQ
-	/* setup and enable 20Hz timer */
+	/* the fixed frequency timers stay disarmed until someone listens
+	  to them, see timer0_set_events() */
 	timer0_20hz_ticks = TIMER0_TICKS_FROM_MS(50);
-	TA0CCR0 = TA0R + timer0_20hz_ticks;
-	TA0CCTL0 |= CCIE;
+}
+
+/* arms or disarms the 20Hz timer, interrupts must be disabled */
+static void timer0_update_20hz(void)
+{
+#ifdef CONFIG_TIMER_20HZ_IRQ
+	if (timer0_events & TIMER0_EVENT_20HZ) {
+		/* start counting from now if it was stopped */
+		if (!(TA0CCTL0 & CCIE)) {
+			TA0CCR0 = TA0R + timer0_20hz_ticks;
+			TA0CCTL0 = CCIE;
+		}
+	} else
+		TA0CCTL0 &= ~CCIE;
 #endif
 }
 
+void timer0_set_events(enum timer0_event events)
+{
+	uint16_t sr;
+
+	TIMER0_LOCK(sr);
+
+	timer0_events = events;
+
+	timer0_update_20hz();
+
+#ifdef CONFIG_TIMER_4S_IRQ
+	if (events & TIMER0_EVENT_4S) {
+		/* do not fire right away from a stale overflow */
+		if (!(TA0CTL & TAIE))
+			TA0CTL = (TA0CTL & ~TAIFG) | TAIE;
+	} else
+		TA0CTL &= ~TAIE;
+#endif
+
+	TIMER0_UNLOCK(sr);
+}
+
 /* This function was based on original Texas Instruments implementation,
    see LICENSE-TI for more information. */
 void timer0_delay(uint16_t duration, uint16_t LPM_bits)
@@ -115,7 +163,7 @@ void timer0_delay(uint16_t duration, uint16_t LPM_bits)
 
 #ifdef USE_WATCHDOG
 		/* Service watchdog */
-		WDTCTL = WDTPW + WDTIS__512K + WDTSSEL__ACLK + WDTCNTCL;
+		WDTCTL = WDTPW + SYS_WATCHDOG_INTERVAL + WDTSSEL__ACLK + WDTCNTCL;
 #endif
 
 		/* The interrupt routine sets delay_finished to signal us
@@ -128,54 +176,182 @@ void timer0_delay(uint16_t duration, uint16_t LPM_bits)
 	TA0CCTL4 &= ~CCIE;
 }
 
-void timer0_delay_callback_destroy(void)
+/* ticks from TA0R to the timer deadline, negative if already due */
+static inline int16_t timer0_swtimer_left(struct timer0_swtimer *timer)
 {
-	/* abort a delay without calling callback */
-	/* disable interrupt */
-	TA0CCTL4 &= ~CCIE;
-	//TA0CCTL2 &= ~CCIE;
-	TA0CCTL2 = 0;
+	return (int16_t)(timer->deadline - TA0R);
+}
 
-	/* clear callback */
-	delay_callback = NULL;
- }
+/* ticks from TA0R to the end of the timer slack */
+static inline int16_t timer0_swtimer_latest(struct timer0_swtimer *timer)
+{
+	return (int16_t)(timer->deadline + timer->slack - TA0R);
+}
 
-void timer0_delay_callback(uint16_t duration, void(*cbfn)(void))
+/* inserts the timer in the list, interrupts must be disabled */
+static void timer0_swtimer_insert(struct timer0_swtimer *timer)
 {
-	timer0_delay_callback_destroy();
+	struct timer0_swtimer **p = &timer0_swtimers;
+	uint16_t latest = timer->deadline + timer->slack;
 
-	/* setup where to go on completion */
-	delay_callback = cbfn;
+	/* keep the list sorted by the end of the slack, the timer goes
+	  after others ending at the same time */
+	while (*p && (int16_t)((*p)->deadline + (*p)->slack - latest) <= 0)
+		p = &(*p)->next;
 
-	/* Set next CCR match */
-	TA0CCR2 = TA0R + TIMER0_TICKS_FROM_MS(duration);
+	timer->next = *p;
+	*p = timer;
+	timer->flags |= TIMER0_SWTIMER_ARMED;
+}
 
-	/* clear any pending interrupt? */
-	TA0CCTL2 = 0;
+/* removes the timer from the list, interrupts must be disabled */
+static void timer0_swtimer_remove(struct timer0_swtimer *timer)
+{
+	struct timer0_swtimer **p = &timer0_swtimers;
 
-	/* enable interrupt */
-	//TA0CCTL2 |= CCIE;
-	TA0CCTL2 = CCIE;
+	if (!(timer->flags & TIMER0_SWTIMER_ARMED))
+		return;
+
+	while (*p != timer)
+		p = &(*p)->next;
+
+	*p = timer->next;
+	timer->flags &= ~TIMER0_SWTIMER_ARMED;
+}
+
+/* programs the end of the first slack in CCR1, the latest moment
+  the first timer can expire. interrupts must be disabled */
+static void timer0_swtimer_program(void)
+{
+	if (!timer0_swtimers) {
+		TA0CCTL1 = 0;
+		return;
+	}
+
+	TA0CCR1 = timer0_swtimers->deadline + timer0_swtimers->slack;
+	TA0CCTL1 = CCIE;
+}
+
+void timer0_swtimer_start(struct timer0_swtimer *timer,
+			  uint16_t duration, uint16_t period, uint16_t slack)
+{
+	uint16_t sr;
+
+	TIMER0_LOCK(sr);
+
+	timer0_swtimer_remove(timer);
+
+	timer->period = TIMER0_TICKS_FROM_MS(period);
+	timer->slack = TIMER0_TICKS_FROM_MS(slack);
+	timer->deadline = TA0R + TIMER0_TICKS_FROM_MS(duration);
+	timer0_swtimer_insert(timer);
+
+	/* the new timer may be the first one to expire */
+	if (timer0_swtimers == timer) {
+		timer0_swtimer_program();
+
+		/* too close to be caught by CCR1, let the ISR handle it */
+		if (timer0_swtimer_latest(timer) < TIMER0_SWTIMER_MARGIN)
+			TA0CCTL1 |= CCIFG;
+	}
+
+	TIMER0_UNLOCK(sr);
+}
+
+void timer0_swtimer_stop(struct timer0_swtimer *timer)
+{
+	uint16_t sr;
+
+	TIMER0_LOCK(sr);
+
+	if (timer0_swtimers == timer) {
+		timer0_swtimer_remove(timer);
+		timer0_swtimer_program();
+	} else
+		timer0_swtimer_remove(timer);
+
+	TIMER0_UNLOCK(sr);
+}
+
+uint8_t timer0_swtimer_service(void)
+{
+	struct timer0_swtimer *timer;
+	uint8_t wakeup = 0;
+
+	if (!timer0_swtimers)
+		return 0;
+
+	while (1) {
+		/* any timer past its deadline expires now, even if its
+		  slack allowed it to wait, so it shares this wakeup */
+		for (timer = timer0_swtimers; timer; timer = timer->next) {
+			if (timer0_swtimer_left(timer) < TIMER0_SWTIMER_MARGIN)
+				break;
+		}
+
+		if (!timer) {
+			timer0_swtimer_program();
+
+			/* the first slack may have ended meanwhile */
+			if (!timer0_swtimers || timer0_swtimer_latest(timer0_swtimers)
+						>= TIMER0_SWTIMER_MARGIN)
+				return wakeup;
+
+			continue;
+		}
+
+		timer0_swtimer_remove(timer);
+
+		/* periodic timers keep their phase */
+		if (timer->period) {
+			timer->deadline += timer->period;
+			timer0_swtimer_insert(timer);
+		}
+
+		if (timer->flags & TIMER0_SWTIMER_WAKEUP)
+			wakeup = 1;
+
+		/* the callback may start or stop timers, including itself */
+		if (timer->fn)
+			timer->fn();
+	}
+}
+
+void timer0_delay_callback_destroy(void)
+{
+	/* abort a delay without calling callback */
+	timer0_swtimer_stop(&timer0_callback_timer);
+}
+
+void timer0_delay_callback(uint16_t duration, void(*cbfn)(void))
+{
+	/* setup where to go on completion */
+	timer0_callback_timer.fn = cbfn;
+	timer0_callback_timer.flags &= ~TIMER0_SWTIMER_WAKEUP;
+
+	timer0_swtimer_start(&timer0_callback_timer, duration, 0, 0);
 }
 
+static void timer0_prog_timer_fn(void)
+{
+	/* queue event */
+	sys_messagebus_post(SYS_MSG_TIMER_PROG);
+}
 
 /* programable timer:
 	duration is in miliseconds, min=1, max=1000 */
 void timer0_create_prog_timer(uint16_t duration)
 {
-	timer0_prog_ticks = TIMER0_TICKS_FROM_MS(duration);
-
-	/* set timer to start as soon as possible */
-	TA0CCR3 = TA0R + timer0_prog_ticks;
+	timer0_prog_timer.fn = timer0_prog_timer_fn;
+	timer0_prog_timer.flags |= TIMER0_SWTIMER_WAKEUP;
 
-	/* enable timer */
-	TA0CCTL3 |= CCIE;
+	timer0_swtimer_start(&timer0_prog_timer, duration, duration, 0);
 }
 
 void timer0_destroy_prog_timer()
 {
 	/* disable timer */
-	TA0CCTL3 &= ~CCIE;
+	timer0_swtimer_stop(&timer0_prog_timer);
 }
 
 
@@ -184,6 +360,10 @@ void timer0_destroy_prog_timer()
 __attribute__((interrupt(TIMER0_A0_VECTOR)))
 void timer0_A0_ISR(void)
 {
+	STACK_SCOPE(timer0_A0_ISR);
+	PROF_SCOPE(timer0_A0_ISR);
+	WAKE_STAT(WAKE_TA0_CCR0);
+
 	/* TODO: Do we need to reset the interrupt flag ? */
 	/* setup timer for next time */
 	TA0CCR0 = TA0R + timer0_20hz_ticks;
@@ -191,8 +371,11 @@ void timer0_A0_ISR(void)
 	/* increase 20hz counter */
 	timer0_20hz_counter++;
 
-	/* store 20hz timer event */
-	timer0_last_event |= TIMER0_EVENT_20HZ;
+	/* software timers waiting in their slack ride on this interrupt */
+	timer0_swtimer_service();
+
+	/* queue 20hz timer event */
+	sys_messagebus_post(SYS_MSG_TIMER_20HZ);
 
 	/* exit from LPM3, give execution back to mainloop */
 	_BIC_SR_IRQ(LPM3_bits);
@@ -202,49 +385,41 @@ void timer0_A0_ISR(void)
 __attribute__((interrupt(TIMER0_A1_VECTOR)))
 void timer0_A1_ISR(void)
 {
+	STACK_SCOPE(timer0_A1_ISR);
+	PROF_SCOPE(timer0_A1_ISR);
+
 	/* reading TA0IV automatically resets the interrupt flag */
 	uint8_t flag = TA0IV;
 
-	/* programable timer */
-	if (flag == TA0IV_TA0CCR3) {
-		/* setup timer for next time */
-		TA0CCR3 = TA0R + timer0_prog_ticks;
+	/* software timers */
+	if (flag == TA0IV_TA0CCR1) {
+		WAKE_STAT(WAKE_TA0_CCR1);
 
-		/* store event */
-		timer0_last_event |= TIMER0_EVENT_PROG;
+		if (timer0_swtimer_service())
+			goto exit_lpm3;
 
-		goto exit_lpm3;
+		/* return to LPM3 (don't mess with SR bits) */
+		return;
 	}
 
 	/* delay timer */
 	if (flag == TA0IV_TA0CCR4) {
+		WAKE_STAT(WAKE_TA0_CCR4);
+		timer0_swtimer_service();
 		delay_finished = 1;
 		goto exit_lpm3;
 	}
 
-	/* one-shot delay timer with callback */
-	if (flag == TA0IV_TA0CCR2) {
-		/* disable interrupt */
-		TA0CCTL2 &= ~CCIE;
-
-		/* maybe call vector */
-		if (delay_callback) {
-			void (*tmpfn)(void) = delay_callback;
-			/* reset timer so it's not called again */
-			delay_callback = NULL;
-			/* but then it may be re-set by callback fn */
-			tmpfn();
-		}
-
-		/* return to LPM3 (don't mess with SR bits) */
-		return;
-	}
-
 
 	/* 0.24Hz timer, ticked by overflow interrupts */
 	if (flag == TA0IV_TA0IFG) {
-		/* store event */
-		timer0_last_event |= TIMER0_EVENT_4S;
+		WAKE_STAT(WAKE_TA0_OVF);
+
+		/* software timers waiting in their slack ride on this interrupt */
+		timer0_swtimer_service();
+
+		/* queue event */
+		sys_messagebus_post(SYS_MSG_TIMER_4S);
 
 		goto exit_lpm3;
 	}
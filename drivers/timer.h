@@ -1,7 +1,7 @@
 /*!
 	\file timer.h
 	\brief openchronos-ng timer driver
-	\details This driver takes care of the Timer0 hardware timer. From this hardware timer the driver produces two hardware-based timers running at 20Hz and 4s (period). The events produced by those timers are available in #sys_message. Beyound the fixed frequency timers, this driver also implements a programmable timer and a programmable delay.
+	\details This driver takes care of the Timer0 hardware timer. From this hardware timer the driver produces two hardware-based timers running at 20Hz and 4s (period). The events produced by those timers are available in #sys_message. The fixed frequency timers only generate interrupts while someone listens to their events in the message bus. Beyound the fixed frequency timers, this driver also implements a programmable timer and a programmable delay.
 	\note If you are looking to timer events, then see #sys_message
 */
 
@@ -20,7 +20,7 @@ void timer0_init(void);
 
 /*!
 	\brief 20Hz counter.
-	\details This is a counter variable, its value is updated at 20Hz. You can use this to measure timings.
+	\details This is a counter variable, its value is updated at 20Hz while the 20Hz timer is running, that is, while someone listens to #SYS_MSG_TIMER_20HZ. You can use this to measure timings.
 	\note counter overflows should be relatively safe since they only happen once each 3276.8 seconds. However you should handle overflows if your application cannot accept sporadic failures in measurement.
 */
 volatile uint16_t timer0_20hz_counter;
@@ -28,7 +28,7 @@ volatile uint16_t timer0_20hz_counter;
 /*!
 	\brief creates a 1000Hz - 1Hz programmable timer
 	\details Creates a timer programmable from 1Hz up to 1000Hz. The timer event is available in #sys_message.
-	\note You should check what modules are using this function because it cannot be used by more than one module at same time. We recommend you use one of the available fixed timers. If you really need another ticking frequency, contact the openchronos-ng developers for a better solution.
+	\note You should check what modules are using this function because it cannot be used by more than one module at same time. We recommend you use one of the available fixed timers. If you really need another ticking frequency, use a software timer, see timer0_swtimer_start().
 	\sa timer0_destroy_prog_timer
 */
 void timer0_create_prog_timer(
@@ -70,6 +70,59 @@ void timer0_delay_callback(
  */
 void timer0_delay_callback_destroy(void);
 
+/*!
+	\brief Flags of a software timer
+*/
+enum timer0_swtimer_flags {
+	TIMER0_SWTIMER_ARMED	= BIT0,	/*!< the timer is running, managed by the driver */
+	TIMER0_SWTIMER_WAKEUP	= BIT1	/*!< exit from low power mode after the callback, so the mainloop runs */
+};
+
+/*!
+	\brief A software timer
+	\details Software timers are owned by the caller, usually as static variables, and share a single hardware compare channel. Set \b fn and optionally #TIMER0_SWTIMER_WAKEUP in \b flags, then use timer0_swtimer_start(). The other fields are managed by the driver.
+*/
+struct timer0_swtimer {
+	struct timer0_swtimer *next; /*!< next timer to expire */
+	void (*fn)(void);            /*!< callback, called from interrupt context */
+	uint16_t deadline;           /*!< TA0R value of the next expiration */
+	uint16_t period;             /*!< period in ticks, 0 for one-shot timers */
+	uint16_t slack;              /*!< ticks the expiration may be delayed to share a wakeup */
+	uint8_t flags;               /*!< see #timer0_swtimer_flags */
+};
+
+/*!
+	\brief Starts a software timer
+	\details Calls \b timer->fn after \b duration milliseconds and then, if \b period is not zero, each \b period milliseconds. Any number of software timers can run at the same time. Starting a running timer restarts it.
+	The expiration may be delayed up to \b slack milliseconds. Timers are then expired together, and with the other timer and RTC interrupts, reducing the number of wakeups from low power mode. Periodic timers keep their nominal phase.
+	\note Durations plus slack must be shorter than 2 seconds. The callback runs in interrupt context, keep it short and use the message bus or #TIMER0_SWTIMER_WAKEUP to hand work to the mainloop. Callbacks can start and stop timers, including their own.
+	\sa timer0_swtimer_stop
+*/
+void timer0_swtimer_start(
+	struct timer0_swtimer *timer, /*!< caller owned timer */
+	uint16_t duration, /*!< delay before the first expiration, between 1 and 1999 milliseconds */
+	uint16_t period, /*!< period between 1 and 1999 milliseconds, 0 for a one-shot timer */
+	uint16_t slack /*!< tolerated delay in milliseconds, 0 to expire on time */
+);
+
+/*!
+	\brief Stops a software timer
+	\details Does nothing if the timer is not running.
+	\sa timer0_swtimer_start
+*/
+void timer0_swtimer_stop(
+	struct timer0_swtimer *timer /*!< caller owned timer */
+);
+
+/*!
+	\brief Expires the software timers past their deadline
+	\details Called from the interrupt routines that wake up anyway, so that timers waiting in their slack expire without a wakeup of their own.
+	\return 1 if an expired timer has #TIMER0_SWTIMER_WAKEUP set
+	\note Must be called from interrupt context.
+	\internal
+*/
+uint8_t timer0_swtimer_service(void);
+
 /*!
 	\brief Bitfield of events produced by this driver
 */
@@ -80,11 +133,13 @@ enum timer0_event {
 };
 
 /*!
-	\brief Bitfield holding the last generated (timer) event.
-	\details Timer0 interrupt routines update this variable with the last happening events. Inside the mainloop, the system then clears this variable after reading it. Read events are broadcasted in #sys_message.
-	\note This function is to be used exclusively by the system. No module is allowed to read or write to this variable.
+	\brief Arms the hardware interrupts of the fixed frequency timers
+	\details Only the timers in \b events generate interrupts, the others are stopped. The system calls this whenever the listeners of the timer events in the message bus change.
+	\note Modules are strictly forbidden to call this function, register to the message bus instead.
 	\internal
 */
-volatile enum timer0_event timer0_last_event;
+void timer0_set_events(
+	enum timer0_event events /*!< bitfield of events someone is listening to */
+);
 
 #endif /* __TIMER_H__ */
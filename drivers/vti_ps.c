@@ -41,6 +41,7 @@
 
 // system
 #include <core/openchronos.h>
+#include <core/pt.h>
 
 // driver
 #include "vti_ps.h"
@@ -81,6 +82,11 @@ static int16_t hLast; // Last altitude estimate in normalized units b/H0/2^15
 // Global flag for proper pressure sensor operation
 uint8_t ps_ok;
 
+// Mode changes are applied by a thread, the sensor needs time to settle after each one
+static struct pt ps_pt;
+static uint8_t ps_sampling; // Current mode, 1=sampling, 0=standby
+static uint8_t ps_request;  // Requested mode
+
 
 // *************************************************************************************************
 // Extern section
@@ -131,23 +137,75 @@ void ps_init(void)
 }
 
 
+// *************************************************************************************************
+// @fn          ps_thread
+// @brief       Apply the requested sensor mode, waiting for the sensor after each change
+// @param       struct pt *pt	Thread
+// @return      enum pt_state
+// *************************************************************************************************
+static enum pt_state ps_thread(struct pt *pt)
+{
+	PT_BEGIN(pt);
+	
+	while (ps_sampling != ps_request)
+	{
+		ps_sampling = ps_request;
+		
+		if (ps_sampling)
+		{
+			// Enable DRDY IRQ on rising edge
+			PS_INT_IFG &= ~PS_INT_PIN;
+			PS_INT_IE |= PS_INT_PIN;
+			
+			// Start sampling data in ultra low power mode
+			ps_write_register(0x03, 0x0B);
+			
+			// 200ms needed to have a working interrupt
+			PT_WAIT_MS_SLACK(pt, 200, 50);
+		}
+		else
+		{
+			// Disable DRDY IRQ
+			PS_INT_IE  &= ~PS_INT_PIN;
+			PS_INT_IFG &= ~PS_INT_PIN;
+			
+			// Put sensor to standby
+			ps_write_register(0x03, 0x00);
+			
+			// 200ms needed ? FIXME
+			PT_WAIT_MS_SLACK(pt, 200, 50);
+		}
+	}
+	
+	PT_END(pt);
+}
+
+
+// *************************************************************************************************
+// @fn          ps_request_mode
+// @brief       Request a sensor mode, applied in the background
+// @param       uint8_t sampling	1=sampling, 0=standby
+// @return      none
+// *************************************************************************************************
+static void ps_request_mode(uint8_t sampling)
+{
+	ps_request = sampling;
+	
+	// A running thread picks the new request once the sensor settled
+	if (!pt_running(&ps_pt))
+		pt_start(&ps_pt, ps_thread);
+}
+
+
 // *************************************************************************************************
 // @fn          ps_start
 // @brief       Init pressure sensor registers and start sampling
 // @param       none
-// @return      uint8_t		1=Sensor started, 0=Sensor did not start
+// @return      none
 // *************************************************************************************************
 void ps_start(void)
 {
-	// Enable DRDY IRQ on rising edge
-	PS_INT_IFG &= ~PS_INT_PIN;
-	PS_INT_IE |= PS_INT_PIN;
-	
-	// Start sampling data in ultra low power mode
-	ps_write_register(0x03, 0x0B);
-	
-	// 200ms needed to have a working interrupt
-	timer0_delay(200, LPM3_bits);
+	ps_request_mode(1);
 }
 
 
@@ -159,15 +217,7 @@ void ps_start(void)
 // *************************************************************************************************
 void ps_stop(void)
 {
-	// Disable DRDY IRQ
-	PS_INT_IE  &= ~PS_INT_PIN;
-	PS_INT_IFG &= ~PS_INT_PIN;
-	
-	// Put sensor to standby
-	ps_write_register(0x03, 0x00);
-	
-	// 200ms needed ? FIXME
-	timer0_delay(200, LPM3_bits);
+	ps_request_mode(0);
 }
 
 
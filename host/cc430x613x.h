@@ -0,0 +1,6 @@
+/**
+	@file	host/cc430x613x.h
+	@brief	Device header for the host simulation build, see host/msp430.h
+ */
+
+#include <msp430.h>
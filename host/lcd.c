@@ -0,0 +1,279 @@
+/**
+	@file	host/lcd.c
+	@brief	Text rendering of the simulated LCD
+
+	@see		http://www.openchronos-ng.sourceforge.net
+	@copyright
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	@details	Decodes the LCD memory back into characters, using the segment wiring of
+				the ez430-chronos glass (see drivers/display.c). Segment patterns shared by
+				several characters decode to the first one, "5" for "S" for instance.
+ */
+
+
+// *************************************************************************************************
+// Include section
+
+#include <ctype.h>
+#include <string.h>
+
+#include "sim.h"
+
+
+// *************************************************************************************************
+// Defines section
+
+#define SEG_A	(BIT4)
+#define SEG_B	(BIT5)
+#define SEG_C	(BIT6)
+#define SEG_D	(BIT7)
+#define SEG_E	(BIT2)
+#define SEG_F	(BIT0)
+#define SEG_G	(BIT1)
+
+#define SWAP_NIBBLE(x)	((((x) << 4) & 0xF0) | (((x) >> 4) & 0x0F))
+
+/// A symbol and where it lives in the LCD memory
+struct lcd_symbol
+{
+	const char *name;
+	uint8_t mem;
+	uint8_t mask;
+};
+
+
+// *************************************************************************************************
+// Global Variable section
+
+/// Characters the display driver can show and their segments
+static const struct
+{
+	char c;
+	uint8_t bits;
+} lcd_glyphs[] = {
+	{'0', SEG_A + SEG_B + SEG_C + SEG_D + SEG_E + SEG_F},
+	{'1', SEG_B + SEG_C},
+	{'2', SEG_A + SEG_B + SEG_D + SEG_E + SEG_G},
+	{'3', SEG_A + SEG_B + SEG_C + SEG_D + SEG_G},
+	{'4', SEG_B + SEG_C + SEG_F + SEG_G},
+	{'5', SEG_A + SEG_C + SEG_D + SEG_F + SEG_G},
+	{'6', SEG_A + SEG_C + SEG_D + SEG_E + SEG_F + SEG_G},
+	{'7', SEG_A + SEG_B + SEG_C},
+	{'8', SEG_A + SEG_B + SEG_C + SEG_D + SEG_E + SEG_F + SEG_G},
+	{'9', SEG_A + SEG_B + SEG_C + SEG_D + SEG_F + SEG_G},
+	{' ', 0},
+	{'-', SEG_G},
+	{'A', SEG_A + SEG_B + SEG_C + SEG_E + SEG_F + SEG_G},
+	{'b', SEG_C + SEG_D + SEG_E + SEG_F + SEG_G},
+	{'c', SEG_D + SEG_E + SEG_G},
+	{'d', SEG_B + SEG_C + SEG_D + SEG_E + SEG_G},
+	{'E', SEG_A + SEG_D + SEG_E + SEG_F + SEG_G},
+	{'f', SEG_A + SEG_E + SEG_F + SEG_G},
+	{'h', SEG_C + SEG_E + SEG_F + SEG_G},
+	{'i', SEG_E},
+	{'J', SEG_A + SEG_B + SEG_C + SEG_D},
+	{'k', SEG_D + SEG_F + SEG_G},
+	{'L', SEG_D + SEG_E + SEG_F},
+	{'M', SEG_A + SEG_B + SEG_C + SEG_E + SEG_F},
+	{'n', SEG_C + SEG_E + SEG_G},
+	{'o', SEG_C + SEG_D + SEG_E + SEG_G},
+	{'P', SEG_A + SEG_B + SEG_E + SEG_F + SEG_G},
+	{'q', SEG_A + SEG_B + SEG_C + SEG_F + SEG_G},
+	{'r', SEG_E + SEG_G},
+	{'t', SEG_D + SEG_E + SEG_F + SEG_G},
+	{'u', SEG_C + SEG_D + SEG_E},
+	{'W', SEG_B + SEG_C + SEG_D + SEG_E + SEG_F + SEG_G},
+	{'X', SEG_B + SEG_C + SEG_E + SEG_F + SEG_G},
+	{'Y', SEG_B + SEG_C + SEG_D + SEG_F + SEG_G},
+	{'<', SEG_A + SEG_F + SEG_G},
+	{'=', SEG_D + SEG_G},
+	{'?', SEG_A + SEG_B + SEG_E + SEG_G},
+	{'[', SEG_B + SEG_E + SEG_G},
+	{']', SEG_C + SEG_F + SEG_G},
+	{'^', SEG_A},
+	{'_', SEG_D},
+};
+
+/// LCD memory offsets of the line 1 digits, left to right
+static const uint8_t lcd_line1[4] = {1, 2, 3, 5};
+
+/// LCD memory offsets of the line 2 digits, left to right (after the leading "1")
+static const uint8_t lcd_line2[5] = {11, 10, 9, 8, 7};
+
+static const struct lcd_symbol lcd_symbols[] = {
+	{"COL1", 0, BIT5},
+	{"DP1", 0, BIT6},
+	{"DP0", 4, BIT2},
+	{"L2COL1", 0, BIT4},
+	{"L2COL0", 4, BIT0},
+	{"L2DP", 8, BIT7},
+	{"UP", 0, BIT2},
+	{"DOWN", 0, BIT3},
+	{"%", 4, BIT4},
+	{"TOTAL", 10, BIT7},
+	{"AVG", 9, BIT7},
+	{"MAX", 7, BIT7},
+	{"BATT", 6, BIT7},
+	{"FT", 4, BIT5},
+	{"K", 4, BIT6},
+	{"M", 6, BIT1},
+	{"I", 6, BIT0},
+	{"/S", 4, BIT7},
+	{"/H", 6, BIT2},
+	{"DEG", 4, BIT1},
+	{"KCAL", 6, BIT4},
+	{"KM", 6, BIT5},
+	{"MI", 6, BIT6},
+	{"HEART", 1, BIT3},
+	{"STOPWATCH", 2, BIT3},
+	{"RECORD", 0, BIT7},
+	{"ALARM", 3, BIT3},
+	{"BEEP1", 4, BIT3},
+	{"BEEP2", 5, BIT3},
+	{"BEEP3", 6, BIT3},
+};
+
+/// What was printed last
+static uint8_t lcd_shown[sizeof(sim_lcdmem)];
+static uint16_t lcd_shown_blink;
+
+
+// *************************************************************************************************
+// Functions section
+
+static char lcd_decode(uint8_t bits)
+{
+	uint8_t i;
+
+	for (i = 0; i < sizeof(lcd_glyphs) / sizeof(lcd_glyphs[0]); i++)
+	{
+		if (lcd_glyphs[i].bits == bits)
+			return lcd_glyphs[i].c;
+	}
+
+	return '*';
+}
+
+int sim_lcd_changed(void)
+{
+	return memcmp(lcd_shown, sim_lcdmem, sizeof(sim_lcdmem))
+		|| lcd_shown_blink != (LCDBBLKCTL & LCDBLKMOD0);
+}
+
+static void lcd_text1(char *text)
+{
+	uint8_t i;
+
+	for (i = 0; i < 4; i++)
+		text[i] = lcd_decode(sim_lcdmem[lcd_line1[i]] & ~BIT3);
+	text[4] = '\0';
+}
+
+void sim_lcd_line2(char *text)
+{
+	uint8_t i;
+
+	text[0] = (sim_lcdmem[11] & BIT7) ? '1' : ' ';
+	for (i = 0; i < 5; i++)
+		text[i + 1] = lcd_decode(SWAP_NIBBLE(sim_lcdmem[lcd_line2[i]] & ~BIT7));
+	text[6] = '\0';
+}
+
+/// The character the display shows for another one, "S" is shown as "5" for instance
+static char lcd_normalize(char c)
+{
+	c = toupper((unsigned char)c);
+
+	switch (c)
+	{
+		case 'S':
+			return '5';
+		case 'G':
+			return '9';
+		case 'Z':
+			return '2';
+		case 'V':
+			return 'U';
+	}
+
+	return c;
+}
+
+int sim_lcd_shows(const char *text)
+{
+	char line2[7];
+	const char *shown = line2;
+
+	sim_lcd_line2(line2);
+
+	while (*shown == ' ')
+		shown++;
+	while (*text == ' ')
+		text++;
+
+	if (!*text)
+		return 0;
+
+	// Shorter texts leave the end of the previous one on the display
+	for (; *text; text++, shown++)
+	{
+		if (!*shown || lcd_normalize(*shown) != lcd_normalize(*text))
+			return 0;
+	}
+
+	return 1;
+}
+
+void sim_lcd_print(FILE *out)
+{
+	char line1[5], line2[7];
+	uint8_t i;
+
+	lcd_text1(line1);
+	sim_lcd_line2(line2);
+
+	fprintf(out, "\"%s\" \"%s\"", line1, line2);
+
+	// AM uses both bits, PM only one
+	if ((sim_lcdmem[0] & (BIT1 | BIT0)) == (BIT1 | BIT0))
+		fprintf(out, " AM");
+	else if (sim_lcdmem[0] & BIT0)
+		fprintf(out, " PM");
+
+	for (i = 0; i < sizeof(lcd_symbols) / sizeof(lcd_symbols[0]); i++)
+	{
+		if (sim_lcdmem[lcd_symbols[i].mem] & lcd_symbols[i].mask)
+			fprintf(out, " %s", lcd_symbols[i].name);
+	}
+
+	// Blinking segments, only shown while blinking is on
+	if (LCDBBLKCTL & LCDBLKMOD0)
+	{
+		for (i = 0; i < 12; i++)
+		{
+			if (sim_lcdmem[0x20 + i])
+			{
+				fprintf(out, " BLINK");
+				break;
+			}
+		}
+	}
+
+	fprintf(out, "\n");
+
+	memcpy(lcd_shown, sim_lcdmem, sizeof(sim_lcdmem));
+	lcd_shown_blink = LCDBBLKCTL & LCDBLKMOD0;
+}
@@ -0,0 +1,546 @@
+/**
+	@file	host/msp430.h
+	@brief	CC430F6137 registers for the host simulation build
+
+	@see		http://www.openchronos-ng.sourceforge.net
+	@copyright
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	@details	Replaces the msp430-libc header when building with "make host". Registers
+				are plain variables owned by host/regs.c, host/sim.c keeps the ones it
+				models up to date when simulated time advances. Interrupt vector registers
+				are accessed through functions so that reading or writing them clears the
+				highest pending flag, like the hardware does. The status register and the
+				intrinsics are routed to the simulator, entering LPM advances time.
+ */
+
+#ifndef __HOST_MSP430_H__
+#define __HOST_MSP430_H__
+
+// *************************************************************************************************
+// Include section
+
+#include <stdint.h>
+
+
+// *************************************************************************************************
+// Defines section
+
+#define BIT0	(0x0001)
+#define BIT1	(0x0002)
+#define BIT2	(0x0004)
+#define BIT3	(0x0008)
+#define BIT4	(0x0010)
+#define BIT5	(0x0020)
+#define BIT6	(0x0040)
+#define BIT7	(0x0080)
+#define BIT8	(0x0100)
+#define BIT9	(0x0200)
+#define BITA	(0x0400)
+#define BITB	(0x0800)
+#define BITC	(0x1000)
+#define BITD	(0x2000)
+#define BITE	(0x4000)
+#define BITF	(0x8000)
+
+/* Memory map, see drivers/display.c and drivers/infomem.h */
+extern uint8_t sim_lcdmem[0x40];
+extern uint16_t sim_infomem[0x100];
+
+/* Stack bounds for core/stackmon.c, the firmware runs on the host stack below main() */
+extern uint16_t *sim_stack_bottom;
+extern uint16_t *sim_stack_top;
+
+#define STACK_BOTTOM	sim_stack_bottom
+#define STACK_TOP		sim_stack_top
+#define STACK_MARGIN	512
+
+#define LCD_MEM_BASE		(sim_lcdmem)
+#define INFOMEM_START		((uintptr_t)sim_infomem)
+
+/* Interrupt vectors, only used to name the routines */
+#define RTC_A_VECTOR		(0)
+#define PORT2_VECTOR		(1)
+#define PORT1_VECTOR		(2)
+#define TIMER1_A1_VECTOR	(3)
+#define TIMER1_A0_VECTOR	(4)
+#define DMA_VECTOR			(5)
+#define CC1101_VECTOR		(6)
+#define TIMER0_A1_VECTOR	(7)
+#define TIMER0_A0_VECTOR	(8)
+#define ADC12_VECTOR		(9)
+#define RESET_VECTOR		(15)
+
+/* __attribute__((interrupt(X))) keeps the routine, host/sim.c calls it */
+#define interrupt(x)		used
+
+
+// *************************************************************************************************
+// Status register and intrinsics
+
+#define GIE			(0x0008)
+#define CPUOFF		(0x0010)
+#define OSCOFF		(0x0020)
+#define SCG0		(0x0040)
+#define SCG1		(0x0080)
+
+#define LPM0_bits	(CPUOFF)
+#define LPM1_bits	(SCG0 + CPUOFF)
+#define LPM2_bits	(SCG1 + CPUOFF)
+#define LPM3_bits	(SCG1 + SCG0 + CPUOFF)
+#define LPM4_bits	(SCG1 + SCG0 + OSCOFF + CPUOFF)
+
+void sim_bis_sr(uint16_t bits);
+void sim_bic_sr(uint16_t bits);
+void sim_bic_sr_irq(uint16_t bits);
+void sim_bis_sr_irq(uint16_t bits);
+uint16_t sim_read_sr(void);
+void sim_write_sr(uint16_t sr);
+void sim_delay_cycles(uint32_t cycles);
+
+#define _BIS_SR(x)						sim_bis_sr(x)
+#define _BIC_SR(x)						sim_bic_sr(x)
+#define _BIS_SR_IRQ(x)					sim_bis_sr_irq(x)
+#define _BIC_SR_IRQ(x)					sim_bic_sr_irq(x)
+#define __bis_SR_register(x)			sim_bis_sr(x)
+#define __bic_SR_register(x)			sim_bic_sr(x)
+#define __bis_SR_register_on_exit(x)	sim_bis_sr_irq(x)
+#define __bic_SR_register_on_exit(x)	sim_bic_sr_irq(x)
+#define __read_status_register()		sim_read_sr()
+#define __get_SR_register()				sim_read_sr()
+#define __write_status_register(x)		sim_write_sr(x)
+#define __get_interrupt_state()			(sim_read_sr() & GIE)
+#define __set_interrupt_state(x)		sim_write_sr((sim_read_sr() & ~GIE) | ((x) & GIE))
+#define __dint()						sim_bic_sr(GIE)
+#define __eint()						sim_bis_sr(GIE)
+#define __disable_interrupt()			sim_bic_sr(GIE)
+#define __enable_interrupt()			sim_bis_sr(GIE)
+#define __no_operation()				((void)0)
+#define __delay_cycles(x)				sim_delay_cycles(x)
+#define __read_stack_pointer()			__builtin_frame_address(0)
+
+
+// *************************************************************************************************
+// Interrupt vector registers, any access resets the highest pending flag
+
+volatile uint16_t *sim_ta0iv(void);
+volatile uint16_t *sim_ta1iv(void);
+volatile uint16_t *sim_rtciv(void);
+volatile uint16_t *sim_p2iv(void);
+volatile uint16_t *sim_adc12iv(void);
+volatile uint16_t *sim_rf1aiv(void);
+volatile uint16_t *sim_dmaiv(void);
+
+#define TA0IV		(*sim_ta0iv())
+#define TA1IV		(*sim_ta1iv())
+#define RTCIV		(*sim_rtciv())
+#define P2IV		(*sim_p2iv())
+#define ADC12IV		(*sim_adc12iv())
+#define RF1AIV		(*sim_rf1aiv())
+#define DMAIV		(*sim_dmaiv())
+
+
+// *************************************************************************************************
+// Special function, watchdog and power management
+
+extern volatile uint16_t SFRIE1;
+extern volatile uint16_t SFRIFG1;
+extern volatile uint16_t WDTCTL;
+extern volatile uint16_t PMMCTL0;
+extern volatile uint16_t PMMIFG;
+extern volatile uint16_t SVSMHCTL;
+extern volatile uint16_t SVSMLCTL;
+
+#define PMMCTL0_L	(((volatile uint8_t *)&PMMCTL0)[0])
+#define PMMCTL0_H	(((volatile uint8_t *)&PMMCTL0)[1])
+
+#define OFIFG		(0x0002)
+
+#define WDTPW		(0x5A00)
+#define WDTHOLD		(0x0080)
+#define WDTSSEL0	(0x0020)
+#define WDTSSEL__ACLK	(0x0020)
+#define WDTTMSEL	(0x0010)
+#define WDTCNTCL	(0x0008)
+#define WDTIS__2G	(0x0000)
+#define WDTIS__128M	(0x0001)
+#define WDTIS__8192K	(0x0002)
+#define WDTIS__512K	(0x0003)
+#define WDTIS__32K	(0x0004)
+#define WDTIS__8192	(0x0005)
+#define WDTIS__512	(0x0006)
+#define WDTIS__64	(0x0007)
+
+#define PMMPW		(0xA500)
+#define PMMCOREV0	(0x0001)
+#define PMMCOREV_3	(0x0003)
+#define PMMHPMRE	(0x0080)
+#define SVSHE		(0x0400)
+#define SVSHRVL0	(0x0100)
+#define SVMHE		(0x4000)
+#define SVSMHRRL0	(0x0001)
+#define SVSLE		(0x0400)
+#define SVSLRVL0	(0x0100)
+#define SVMLE		(0x0010)
+#define SVSMLRRL0	(0x0001)
+#define SVSMLDLYIFG	(0x0001)
+#define SVMLIFG		(0x0002)
+#define SVMLVLRIFG	(0x0004)
+
+
+// *************************************************************************************************
+// Unified clock system, simulated with ACLK at 32768Hz and SMCLK at 12MHz
+
+extern volatile uint16_t UCSCTL0;
+extern volatile uint16_t UCSCTL1;
+extern volatile uint16_t UCSCTL2;
+extern volatile uint16_t UCSCTL3;
+extern volatile uint16_t UCSCTL4;
+extern volatile uint16_t UCSCTL5;
+extern volatile uint16_t UCSCTL6;
+extern volatile uint16_t UCSCTL7;
+extern volatile uint16_t UCSCTL8;
+
+#define XT1OFF			(0x0001)
+#define XCAP_3			(0x000C)
+#define SELA__XT1CLK	(0x0000)
+#define SELS__DCOCLKDIV	(0x0040)
+#define SELM__DCOCLKDIV	(0x0004)
+#define DCORSEL_5		(0x0050)
+#define FLLD_1			(0x1000)
+#define DCOFFG			(0x0001)
+#define XT1LFOFFG		(0x0002)
+#define XT1HFOFFG		(0x0004)
+#define XT2OFFG			(0x0008)
+
+
+// *************************************************************************************************
+// Flash controller, never busy
+
+extern volatile uint16_t FCTL1;
+extern volatile uint16_t FCTL3;
+extern volatile uint16_t FCTL4;
+
+#define FRKEY		(0x9600)
+#define FWKEY		(0xA500)
+#define ERASE		(0x0002)
+#define MERAS		(0x0004)
+#define WRT			(0x0040)
+#define BLKWRT		(0x0080)
+#define BUSY		(0x0001)
+#define KEYV		(0x0002)
+#define ACCVIFG		(0x0004)
+#define WAIT		(0x0008)
+#define LOCK		(0x0010)
+#define EMEX		(0x0020)
+#define LOCKA		(0x0040)
+#define LOCKINFO	(0x0080)
+
+
+// *************************************************************************************************
+// Ports and port mapping
+
+extern volatile uint8_t P1IN, P1OUT, P1DIR, P1REN, P1SEL, P1IE, P1IES, P1IFG;
+extern volatile uint8_t P2IN, P2OUT, P2DIR, P2REN, P2SEL, P2IE, P2IES, P2IFG;
+extern volatile uint8_t P3IN, P3OUT, P3DIR, P3REN, P3SEL;
+extern volatile uint8_t P4IN, P4OUT, P4DIR, P4REN, P4SEL;
+extern volatile uint8_t P5IN, P5OUT, P5DIR, P5REN, P5SEL;
+extern volatile uint8_t PJIN, PJOUT, PJDIR, PJREN;
+extern volatile uint16_t PMAPPWD;
+extern volatile uint16_t PMAPCTL;
+extern volatile uint8_t sim_p1map[8];
+extern volatile uint8_t sim_p2map[8];
+
+#define P1MAP0		(sim_p1map[0])
+#define P2MAP0		(sim_p2map[0])
+
+#define PMAPRECFG	(0x0002)
+#define PM_NONE		(0)
+#define PM_UCA0CLK	(5)
+#define PM_UCA0SOMI	(6)
+#define PM_UCA0SIMO	(7)
+#define PM_TA1CCR0A	(17)
+
+
+// *************************************************************************************************
+// Timer_A, TA0 has 5 capture/compare registers and TA1 3
+
+extern volatile uint16_t TA0CTL, TA0R, TA0EX0;
+extern volatile uint16_t TA0CCTL0, TA0CCTL1, TA0CCTL2, TA0CCTL3, TA0CCTL4;
+extern volatile uint16_t TA0CCR0, TA0CCR1, TA0CCR2, TA0CCR3, TA0CCR4;
+extern volatile uint16_t TA1CTL, TA1R, TA1EX0;
+extern volatile uint16_t TA1CCTL0, TA1CCTL1, TA1CCTL2;
+extern volatile uint16_t TA1CCR0, TA1CCR1, TA1CCR2;
+
+#define TASSEL__TACLK	(0x0000)
+#define TASSEL__ACLK	(0x0100)
+#define TASSEL__SMCLK	(0x0200)
+#define TASSEL__INCLK	(0x0300)
+#define ID__1			(0x0000)
+#define ID__2			(0x0040)
+#define ID__4			(0x0080)
+#define ID__8			(0x00C0)
+#define MC_0			(0x0000)
+#define MC_1			(0x0010)
+#define MC_2			(0x0020)
+#define MC_3			(0x0030)
+#define MC__STOP		(0x0000)
+#define MC__UP			(0x0010)
+#define MC__CONTINOUS	(0x0020)
+#define MC__CONTINUOUS	(0x0020)
+#define MC__UPDOWN		(0x0030)
+#define TACLR			(0x0004)
+#define TAIE			(0x0002)
+#define TAIFG			(0x0001)
+
+#define CM_3		(0xC000)
+#define CAP			(0x0100)
+#define OUTMOD_4	(0x0080)
+#define OUTMOD_7	(0x00E0)
+#define CCIE		(0x0010)
+#define CCI			(0x0008)
+#define OUT			(0x0004)
+#define COV			(0x0002)
+#define CCIFG		(0x0001)
+
+#define TA0IV_NONE		(0x0000)
+#define TA0IV_TA0CCR1	(0x0002)
+#define TA0IV_TA0CCR2	(0x0004)
+#define TA0IV_TA0CCR3	(0x0006)
+#define TA0IV_TA0CCR4	(0x0008)
+#define TA0IV_TA0IFG	(0x000E)
+#define TA1IV_NONE		(0x0000)
+#define TA1IV_TA1CCR1	(0x0002)
+#define TA1IV_TA1CCR2	(0x0004)
+#define TA1IV_TA1IFG	(0x000E)
+
+
+// *************************************************************************************************
+// RTC_A in calendar mode, RTCCTL0 and RTCCTL1 are the bytes of RTCCTL01
+
+extern volatile uint16_t RTCCTL01;
+extern volatile uint16_t RTCCTL23;
+extern volatile uint16_t RTCPS0CTL;
+extern volatile uint16_t RTCPS1CTL;
+extern volatile uint8_t RTCPS0, RTCPS1;
+extern volatile uint8_t RTCSEC, RTCMIN, RTCHOUR, RTCDOW, RTCDAY, RTCMON;
+extern volatile uint16_t RTCYEAR;
+extern volatile uint8_t RTCAMIN, RTCAHOUR, RTCADOW, RTCADAY;
+
+#define RTCCTL0		(((volatile uint8_t *)&RTCCTL01)[0])
+#define RTCCTL1		(((volatile uint8_t *)&RTCCTL01)[1])
+#define RTCYEARL	(((volatile uint8_t *)&RTCYEAR)[0])
+#define RTCYEARH	(((volatile uint8_t *)&RTCYEAR)[1])
+#define RTCNT1		RTCSEC
+#define RTCNT2		RTCMIN
+#define RTCNT3		RTCHOUR
+#define RTCNT4		RTCDOW
+
+#define RTCBCD		(0x8000)
+#define RTCHOLD		(0x4000)
+#define RTCMODE		(0x2000)
+#define RTCRDY		(0x1000)
+#define RTCSSEL_0	(0x0000)
+#define RTCTEV_0	(0x0000)
+#define RTCTEV_1	(0x0100)
+#define RTCTEV_2	(0x0200)
+#define RTCTEV_3	(0x0300)
+#define RTCOFIE		(0x0080)
+#define RTCTEVIE	(0x0040)
+#define RTCAIE		(0x0020)
+#define RTCRDYIE	(0x0010)
+#define RTCOFIFG	(0x0008)
+#define RTCTEVIFG	(0x0004)
+#define RTCAIFG		(0x0002)
+#define RTCRDYIFG	(0x0001)
+#define RTCAE		(0x80)
+
+#define RTCIV_NONE		(0x0000)
+#define RTCIV_RTCRDYIFG	(0x0002)
+#define RTCIV_RTCTEVIFG	(0x0004)
+#define RTCIV_RTCAIFG	(0x0006)
+#define RTCIV_RT0PSIFG	(0x0008)
+#define RTCIV_RT1PSIFG	(0x000A)
+
+
+// *************************************************************************************************
+// Shared reference and ADC12_A, conversions complete right after they are started
+
+extern volatile uint16_t REFCTL0;
+extern volatile uint16_t ADC12CTL0, ADC12CTL1, ADC12CTL2;
+extern volatile uint16_t ADC12IE, ADC12IFG;
+extern volatile uint8_t ADC12MCTL0;
+extern volatile uint16_t ADC12MEM0;
+
+#define REFMSTR			(0x0080)
+#define REFVSEL_0		(0x0000)
+#define REFVSEL_1		(0x0010)
+#define REFVSEL_2		(0x0020)
+#define REFVSEL_3		(0x0030)
+#define REFTCOFF		(0x0008)
+#define REFOUT			(0x0002)
+#define REFON			(0x0001)
+
+#define ADC12SHT0_8		(0x0800)
+#define ADC12SHT0_10	(0x0A00)
+#define ADC12MSC		(0x0080)
+#define ADC12ON			(0x0010)
+#define ADC12ENC		(0x0002)
+#define ADC12SC			(0x0001)
+#define ADC12SHP		(0x0200)
+#define ADC12BUSY		(0x0001)
+#define ADC12SREF_1		(0x10)
+#define ADC12EOS		(0x80)
+#define ADC12INCH_10	(0x0A)
+#define ADC12INCH_11	(0x0B)
+
+
+// *************************************************************************************************
+// LCD_B, the memory is sim_lcdmem, LCDCLRM and LCDCLRBM apply on the next simulator step
+
+extern volatile uint16_t LCDBCTL0, LCDBCTL1, LCDBBLKCTL, LCDBMEMCTL;
+extern volatile uint16_t LCDBVCTL, LCDBPCTL0, LCDBPCTL1, LCDBPCTL2;
+
+#define LCDDIV0		(0x0800)
+#define LCDDIV1		(0x1000)
+#define LCDDIV2		(0x2000)
+#define LCDDIV3		(0x4000)
+#define LCDDIV4		(0x8000)
+#define LCDPRE0		(0x0100)
+#define LCDPRE1		(0x0200)
+#define LCDPRE2		(0x0400)
+#define LCD4MUX		(0x0018)
+#define LCDSON		(0x0004)
+#define LCDON		(0x0001)
+#define LCDBLKDIV0	(0x0020)
+#define LCDBLKDIV1	(0x0040)
+#define LCDBLKDIV2	(0x0080)
+#define LCDBLKPRE0	(0x0004)
+#define LCDBLKPRE1	(0x0008)
+#define LCDBLKPRE2	(0x0010)
+#define LCDBLKMOD0	(0x0001)
+#define LCDBLKMOD1	(0x0002)
+#define LCDCLRBM	(0x0004)
+#define LCDCLRM		(0x0002)
+#define LCDDISP		(0x0001)
+#define LCDCPEN		(0x0008)
+#define VLCD_2_72	(0x0C00)
+
+
+// *************************************************************************************************
+// USCI_A0 in SPI mode, transfers complete at once and receive zeros
+
+extern volatile uint8_t UCA0CTL0, UCA0CTL1, UCA0BR0, UCA0BR1;
+extern volatile uint8_t UCA0STAT, UCA0IE, UCA0IFG;
+extern volatile uint8_t UCA0TXBUF, UCA0RXBUF;
+
+#define UCCKPH		(0x80)
+#define UCCKPL		(0x40)
+#define UCMSB		(0x20)
+#define UCMST		(0x08)
+#define UCSYNC		(0x01)
+#define UCSSEL1		(0x80)
+#define UCSSEL0		(0x40)
+#define UCSWRST		(0x01)
+#define UCTXIFG		(0x02)
+#define UCRXIFG		(0x01)
+
+
+// *************************************************************************************************
+// RF1A radio interface, always ready, the radio core answers with zeros
+
+extern volatile uint16_t RF1AIFCTL0, RF1AIFERR;
+extern volatile uint16_t RF1AIFG, RF1AIE, RF1AIN, RF1AIES;
+extern volatile uint16_t RF1AINSTRW;
+extern volatile uint8_t RF1AINSTR1B, RF1AINSTR2B;
+extern volatile uint16_t RF1ADOUTW;
+extern volatile uint8_t RF1ADOUT0B, RF1ADOUT1B, RF1ADOUT2B;
+extern volatile uint8_t RF1ASTAT0B, RF1ASTAT1B, RF1ASTAT2B;
+
+/* the interface flags are set again on every read */
+volatile uint16_t *sim_rf1aifctl1(void);
+#define RF1AIFCTL1	(*sim_rf1aifctl1())
+
+#define RF1AINSTRB	(((volatile uint8_t *)&RF1AINSTRW)[1])
+#define RF1ADINB	(((volatile uint8_t *)&RF1AINSTRW)[0])
+#define RF1ADOUTB	(((volatile uint8_t *)&RF1ADOUTW)[0])
+#define RF1ASTATB	RF1ASTAT0B
+
+#define RFDINIFG	(0x0100)
+#define RFINSTRIFG	(0x0200)
+#define RFDOUTIFG	(0x0400)
+#define RFSTATIFG	(0x0800)
+#define RFERRIFG	(0x0001)
+#define RF1AIV_NONE	(0x0000)
+
+#define RF_SRES		(0x30)
+#define RF_SFSTXON	(0x31)
+#define RF_SXOFF	(0x32)
+#define RF_SCAL		(0x33)
+#define RF_SRX		(0x34)
+#define RF_STX		(0x35)
+#define RF_SIDLE	(0x36)
+#define RF_SWOR		(0x38)
+#define RF_SPWD		(0x39)
+#define RF_SFRX		(0x3A)
+#define RF_SFTX		(0x3B)
+#define RF_SWORRST	(0x3C)
+#define RF_SNOP		(0x3D)
+#define RF_REGWR	(0x00)
+#define RF_REGRD	(0x80)
+#define RF_RXFIFORD	(0xBF)
+#define RF_TXFIFOWR	(0x3F)
+#define IOCFG2		(0x00)
+#define PATABLE		(0x3E)
+
+
+// *************************************************************************************************
+// DMA, the transfers requested by DMAREQ are done at the next access to a channel control register
+
+#define DMAREQ			(0x0001)
+#define DMAABORT		(0x0002)
+#define DMAIE			(0x0004)
+#define DMAIFG			(0x0008)
+#define DMAEN			(0x0010)
+#define DMALEVEL		(0x0020)
+#define DMASRCBYTE		(0x0040)
+#define DMADSTBYTE		(0x0080)
+#define DMASRCINCR_0	(0x0000)
+#define DMASRCINCR_2	(0x0200)
+#define DMASRCINCR_3	(0x0300)
+#define DMADSTINCR_0	(0x0000)
+#define DMADSTINCR_2	(0x0800)
+#define DMADSTINCR_3	(0x0C00)
+#define DMADT_0			(0x0000)
+#define DMADT_1			(0x1000)
+#define DMA0TSEL_0		(0x0000)
+#define DMA1TSEL_0		(0x0000)
+#define DMA2TSEL_0		(0x0000)
+#define DMAIV_DMA0IFG	(0x0002)
+#define DMAIV_DMA1IFG	(0x0004)
+#define DMAIV_DMA2IFG	(0x0006)
+
+volatile uint16_t *sim_dmactl(uint8_t ch);
+
+#define DMA0CTL		(*sim_dmactl(0))
+#define DMA1CTL		(*sim_dmactl(1))
+#define DMA2CTL		(*sim_dmactl(2))
+
+extern volatile uint16_t DMACTL0, DMACTL1, DMACTL2, DMACTL4;
+extern volatile uint16_t DMA0SZ, DMA1SZ, DMA2SZ;
+extern volatile uintptr_t DMA0SA, DMA1SA, DMA2SA;
+extern volatile uintptr_t DMA0DA, DMA1DA, DMA2DA;
+
+#endif /* __HOST_MSP430_H__ */
@@ -0,0 +1,111 @@
+/**
+	@file	host/regs.c
+	@brief	Register storage for the host simulation build
+
+	@see		http://www.openchronos-ng.sourceforge.net
+	@copyright
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	@details	Registers start with their reset values. Flags the drivers busy-wait on
+				read as ready, see host/msp430.h.
+ */
+
+
+// *************************************************************************************************
+// Include section
+
+#include <msp430.h>
+
+
+// *************************************************************************************************
+// Global Variable section
+
+/* LCD memory (0x0A20) and blink memory (0x0A40) */
+uint8_t sim_lcdmem[0x40];
+
+/* Info memory segments D, C, B and A, erased, aligned like the real ones */
+uint16_t sim_infomem[0x100] __attribute__((aligned(0x200))) = {
+	[0 ... 0xff] = 0xffff
+};
+
+volatile uint16_t SFRIE1;
+volatile uint16_t SFRIFG1 = OFIFG;
+volatile uint16_t WDTCTL = 0x6904;
+volatile uint16_t PMMCTL0 = 0x9600;
+volatile uint16_t PMMIFG = SVSMLDLYIFG | SVMLVLRIFG;
+volatile uint16_t SVSMHCTL;
+volatile uint16_t SVSMLCTL;
+
+volatile uint16_t UCSCTL0, UCSCTL1, UCSCTL2, UCSCTL3, UCSCTL4;
+volatile uint16_t UCSCTL5, UCSCTL6, UCSCTL7, UCSCTL8;
+
+volatile uint16_t FCTL1 = FRKEY;
+volatile uint16_t FCTL3 = FRKEY | LOCKA | LOCK | WAIT;
+volatile uint16_t FCTL4 = FRKEY | LOCKINFO;
+
+volatile uint8_t P1IN, P1OUT, P1DIR, P1REN, P1SEL, P1IE, P1IES, P1IFG;
+volatile uint8_t P2IN, P2OUT, P2DIR, P2REN, P2SEL, P2IE, P2IES, P2IFG;
+volatile uint8_t P3IN, P3OUT, P3DIR, P3REN, P3SEL;
+volatile uint8_t P4IN, P4OUT, P4DIR, P4REN, P4SEL;
+volatile uint8_t P5IN, P5OUT, P5DIR, P5REN, P5SEL;
+/* the pressure sensor bus idles high, nobody answers */
+volatile uint8_t PJIN = 0x0f, PJOUT, PJDIR, PJREN;
+volatile uint16_t PMAPPWD;
+volatile uint16_t PMAPCTL;
+volatile uint8_t sim_p1map[8];
+volatile uint8_t sim_p2map[8];
+
+volatile uint16_t TA0CTL, TA0R, TA0EX0;
+volatile uint16_t TA0CCTL0, TA0CCTL1, TA0CCTL2, TA0CCTL3, TA0CCTL4;
+volatile uint16_t TA0CCR0, TA0CCR1, TA0CCR2, TA0CCR3, TA0CCR4;
+volatile uint16_t TA1CTL, TA1R, TA1EX0;
+volatile uint16_t TA1CCTL0, TA1CCTL1, TA1CCTL2;
+volatile uint16_t TA1CCR0, TA1CCR1, TA1CCR2;
+
+volatile uint16_t RTCCTL01 = RTCHOLD;
+volatile uint16_t RTCCTL23;
+volatile uint16_t RTCPS0CTL;
+volatile uint16_t RTCPS1CTL;
+volatile uint8_t RTCPS0, RTCPS1;
+volatile uint8_t RTCSEC, RTCMIN, RTCHOUR, RTCDOW, RTCDAY = 1, RTCMON = 1;
+volatile uint16_t RTCYEAR;
+volatile uint8_t RTCAMIN, RTCAHOUR, RTCADOW, RTCADAY;
+
+volatile uint16_t REFCTL0;
+volatile uint16_t ADC12CTL0, ADC12CTL1, ADC12CTL2;
+volatile uint16_t ADC12IE, ADC12IFG;
+volatile uint8_t ADC12MCTL0;
+volatile uint16_t ADC12MEM0;
+
+volatile uint16_t LCDBCTL0, LCDBCTL1, LCDBBLKCTL, LCDBMEMCTL;
+volatile uint16_t LCDBVCTL, LCDBPCTL0, LCDBPCTL1, LCDBPCTL2;
+
+volatile uint8_t UCA0CTL0, UCA0CTL1 = UCSWRST, UCA0BR0, UCA0BR1;
+volatile uint8_t UCA0STAT, UCA0IE, UCA0IFG = UCTXIFG | UCRXIFG;
+volatile uint8_t UCA0TXBUF, UCA0RXBUF;
+
+volatile uint16_t RF1AIFCTL0;
+volatile uint16_t RF1AIFERR;
+volatile uint16_t RF1AIFG, RF1AIE, RF1AIN, RF1AIES;
+volatile uint16_t RF1AINSTRW;
+volatile uint8_t RF1AINSTR1B, RF1AINSTR2B;
+volatile uint16_t RF1ADOUTW;
+volatile uint8_t RF1ADOUT0B, RF1ADOUT1B, RF1ADOUT2B;
+volatile uint8_t RF1ASTAT0B, RF1ASTAT1B, RF1ASTAT2B;
+
+volatile uint16_t DMACTL0, DMACTL1, DMACTL2, DMACTL4;
+volatile uint16_t DMA0SZ, DMA1SZ, DMA2SZ;
+volatile uintptr_t DMA0SA, DMA1SA, DMA2SA;
+volatile uintptr_t DMA0DA, DMA1DA, DMA2DA;
@@ -0,0 +1,1640 @@
+/**
+	@file	host/sim.c
+	@brief	Host simulation of the ez430-chronos hardware
+
+	@see		http://www.openchronos-ng.sourceforge.net
+	@copyright
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+	@details	Runs the unmodified firmware mainloop on the host. The CPU is infinitely
+				fast: simulated time only advances while the firmware sleeps in LPM or
+				burns cycles with __delay_cycles(). Sleeping jumps straight to the next
+				interrupt the hardware would raise, so hours of watch time run in
+				milliseconds.
+
+				Simulated peripherals:
+				- TA0 and TA1: continuous and up modes, compare flags, overflow, ACLK
+				  and SMCLK sources with dividers (up/down mode counts like up mode)
+				- RTC_A: calendar mode in binary or BCD, read ready, time event and
+				  alarm flags, the RT0PS/RT1PS prescalers
+				- PORT2: buttons driven by a script, edge select and flags
+				- ADC12: conversions complete at once with the values of the channels
+				- LCD_B: memory at #sim_lcdmem, printed whenever the firmware goes to
+				  sleep with a changed display
+				- DMA: transfers started by DMAREQ, done at once when the firmware next
+				  accesses a channel control register, completion flags
+				- watchdog: an expired watchdog stops the simulation
+				The interrupt routines are found by name, like the vector table does
+				on the target.
+
+				Script lines are "<seconds> <command> [arguments]", the time is absolute
+				or relative to the previous line when it starts with '+':
+				@code
+				# long press on STAR, then two short presses on UP
+				1.0   goto   alarm
+				+10   hold   star 1.5
+				+1.0  click  up
+				+0.5  click  up
+				+0.5  adc    11 2870
+				60    quit
+				@endcode
+				Commands are press, release, click (100ms press), hold (press for the
+				given seconds), adc (set the conversion result of a channel), goto (walk
+				the menu to an entry and activate it, leave some seconds for it), lcd
+				(print the display) and quit. Buttons are star, num, up, down and
+				backlight.
+
+				With -e the time spent in each power state (CPU awake, LPM1, LPM3, LCD,
+				ADC, reference, buzzer and radio) is printed at the end, see
+				tools/energy/energy.py.
+
+				With -T the event trace is written at the end in the format of mspdebug,
+				so a replayed field trace can be compared with the original one.
+
+				With -C the epoch and calendar conversions of drivers/rtca.c are checked
+				against the C library for every day of 2000 to 2099, nothing is simulated.
+ */
+
+
+// *************************************************************************************************
+// Include section
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <core/trace.h>
+#include <drivers/rtca.h>
+
+#include "sim.h"
+
+
+// *************************************************************************************************
+// Defines section
+
+/// No event pending
+#define SIM_NEVER			(~(uint64_t)0)
+
+/// Interrupts serviced without time moving before the simulation gives up
+#define SIM_STORM			10000
+
+/// Maximum number of script events
+#define SIM_SCRIPT_SIZE		1024
+
+/// Host stack words below main() painted by core/stackmon.c, host frames are much larger
+#define SIM_STACK_WORDS		16384
+
+/// Menu entries tried by goto before giving up
+#define SIM_GOTO_TRIES		32
+
+/// ACLK cycles from seconds
+#define SIM_TICKS(s)		((uint64_t)((s) * SIM_ACLK_HZ + 0.5))
+
+/// Buttons on PORT2, see drivers/ports.h
+#define SIM_BTN_DOWN		(BIT0)
+#define SIM_BTN_NUM			(BIT1)
+#define SIM_BTN_STAR		(BIT2)
+#define SIM_BTN_BL			(BIT3)
+#define SIM_BTN_UP			(BIT4)
+
+/// A Timer_A instance
+struct sim_timer
+{
+	volatile uint16_t *ctl;
+	volatile uint16_t *r;
+	volatile uint16_t *ex0;
+	volatile uint16_t *cctl[5];
+	volatile uint16_t *ccr[5];
+	uint8_t ccrs;
+};
+
+/// An interrupt vector
+struct sim_vector
+{
+	const char *name;
+	uint8_t (*pending)(void);
+	void (*ack)(void);
+	void (*isr)(void);
+	unsigned long count;
+};
+
+/// Script commands
+enum sim_command
+{
+	SIM_PRESS,
+	SIM_RELEASE,
+	SIM_ADC,
+	SIM_LCD,
+	SIM_GOTO,
+	SIM_GOTO_STEP,
+	SIM_QUIT,
+};
+
+/// A script event
+struct sim_event
+{
+	uint64_t at;
+	enum sim_command cmd;
+	uint16_t arg;
+	uint16_t value;
+	char text[8];
+};
+
+/// Time spent in each power state, in ACLK cycles
+struct sim_energy
+{
+	uint64_t active;
+	uint64_t lpm1;
+	uint64_t lpm3;
+	uint64_t lcd;
+	uint64_t lcd_pump;
+	uint64_t adc;
+	uint64_t ref;
+	uint64_t buzzer;
+	uint64_t radio_rx;
+	uint64_t radio_tx;
+
+	/// MCLK cycles spent in __delay_cycles()
+	uint64_t delay_cycles;
+};
+
+/// Radio core states, as far as the strobes tell
+enum sim_radio_state
+{
+	SIM_RADIO_OFF,
+	SIM_RADIO_RX,
+	SIM_RADIO_TX,
+};
+
+
+// *************************************************************************************************
+// Extern section
+
+/* interrupt routines, missing ones are NULL */
+extern void ADC12ISR(void) __attribute__((weak));
+extern void timer0_A0_ISR(void) __attribute__((weak));
+extern void timer0_A1_ISR(void) __attribute__((weak));
+extern void radio_ISR(void) __attribute__((weak));
+extern void prof_TA1_ISR(void) __attribute__((weak));
+extern void PORT2_ISR(void) __attribute__((weak));
+extern void RTC_A_ISR(void) __attribute__((weak));
+extern void DMA_ISR(void) __attribute__((weak));
+
+/* the event trace, NULL without CONFIG_TRACE */
+extern struct trace trace __attribute__((weak));
+
+
+// *************************************************************************************************
+// Global Variable section
+
+/// Simulated time, in ACLK cycles since reset
+static uint64_t sim_now;
+
+/// The simulation stops at this time
+static uint64_t sim_end = SIM_NEVER;
+
+/// Host stack given to the firmware, see core/stackmon.c
+uint16_t *sim_stack_top;
+uint16_t *sim_stack_bottom;
+
+/// Status register, and the ones saved by the interrupts being serviced
+static uint16_t sim_sr;
+static uint16_t sim_sr_saved[8];
+static uint8_t sim_depth;
+
+/// MCLK cycles not yet converted to ACLK cycles by sim_delay_cycles()
+static uint64_t sim_mclk_frac;
+
+/// ACLK cycles into the current RTC second
+static uint32_t sim_rtc_phase;
+
+/// Time of the last watchdog clear
+static uint64_t sim_wdt_cleared;
+
+/// Script, sorted by time
+static struct sim_event sim_script[SIM_SCRIPT_SIZE];
+static unsigned sim_script_len;
+static unsigned sim_script_next;
+
+/// ADC12 conversion results per channel
+static uint16_t sim_adc[16] = {
+	[10] = 2269,	// temperature sensor, 25C
+	[11] = 3075,	// AVCC/2, 3.0V battery
+};
+
+/// Print the display when it changes
+static int sim_verbose = 1;
+
+/// Statistics
+static unsigned long sim_sleeps;
+static unsigned long sim_storm;
+
+/// Power state accounting, printed at the end with -e
+static struct sim_energy sim_energy;
+static int sim_energy_report;
+static enum sim_radio_state sim_radio;
+
+/// Host CPU time spent in the firmware, awake
+static struct timespec sim_awake_since;
+static double sim_awake_host;
+
+static struct sim_timer sim_ta0 = {
+	&TA0CTL, &TA0R, &TA0EX0,
+	{&TA0CCTL0, &TA0CCTL1, &TA0CCTL2, &TA0CCTL3, &TA0CCTL4},
+	{&TA0CCR0, &TA0CCR1, &TA0CCR2, &TA0CCR3, &TA0CCR4},
+	5
+};
+
+/// DMA channel control registers, see sim_dmactl()
+static uint16_t sim_dma_ctl[3];
+
+static volatile uintptr_t * const sim_dma_sa[3] = {&DMA0SA, &DMA1SA, &DMA2SA};
+static volatile uintptr_t * const sim_dma_da[3] = {&DMA0DA, &DMA1DA, &DMA2DA};
+static volatile uint16_t * const sim_dma_sz[3] = {&DMA0SZ, &DMA1SZ, &DMA2SZ};
+
+static struct sim_timer sim_ta1 = {
+	&TA1CTL, &TA1R, &TA1EX0,
+	{&TA1CCTL0, &TA1CCTL1, &TA1CCTL2},
+	{&TA1CCR0, &TA1CCR1, &TA1CCR2},
+	3
+};
+
+/// Value returned by the interrupt vector registers
+static volatile uint16_t sim_iv;
+
+
+// *************************************************************************************************
+// Prototypes section
+
+static void sim_vectors_print(FILE *out);
+static struct sim_event *sim_script_add(uint64_t at, enum sim_command cmd, uint16_t arg, uint16_t value);
+
+
+// *************************************************************************************************
+// Functions section
+
+static double sim_seconds(void)
+{
+	return (double)sim_now / SIM_ACLK_HZ;
+}
+
+static double sim_host_time(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void sim_awake(void)
+{
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &sim_awake_since);
+}
+
+static void sim_asleep(void)
+{
+	sim_awake_host += sim_host_time()
+		- (sim_awake_since.tv_sec + sim_awake_since.tv_nsec / 1e9);
+}
+
+static unsigned long sim_interrupts(void);
+
+/// Print the power state accounting, "energy <name> <value>" lines, times in seconds
+static void sim_energy_print(FILE *out)
+{
+	const struct
+	{
+		const char *name;
+		uint64_t ticks;
+	} states[] = {
+		{"time", sim_now},
+		{"active", sim_energy.active},
+		{"lpm1", sim_energy.lpm1},
+		{"lpm3", sim_energy.lpm3},
+		{"lcd", sim_energy.lcd},
+		{"lcd_pump", sim_energy.lcd_pump},
+		{"adc", sim_energy.adc},
+		{"ref", sim_energy.ref},
+		{"buzzer", sim_energy.buzzer},
+		{"radio_rx", sim_energy.radio_rx},
+		{"radio_tx", sim_energy.radio_tx},
+	};
+	uint8_t i;
+
+	for (i = 0; i < sizeof(states) / sizeof(states[0]); i++)
+		fprintf(out, "energy %s %.6f\n", states[i].name, (double)states[i].ticks / SIM_ACLK_HZ);
+
+	fprintf(out, "energy wakeups %lu\n", sim_sleeps);
+	fprintf(out, "energy interrupts %lu\n", sim_interrupts());
+	fprintf(out, "energy delay_cycles %llu\n", (unsigned long long)sim_energy.delay_cycles);
+}
+
+/// Where to write the event trace at the end, NULL for nowhere
+static const char *sim_trace_path;
+
+/// Write the event trace like "md trace" does in mspdebug, see tools/trace/trace.py
+static void sim_trace_write(const char *path)
+{
+	const uint8_t *p = (const uint8_t *)&trace;
+	FILE *out;
+	size_t i, j;
+
+	if (!p)
+	{
+		fprintf(stderr, "sim: the firmware was built without CONFIG_TRACE\n");
+		return;
+	}
+
+	out = strcmp(path, "-") ? fopen(path, "w") : stdout;
+	if (!out)
+	{
+		perror(path);
+		return;
+	}
+
+	for (i = 0; i < sizeof(trace); i += 16)
+	{
+		fprintf(out, "    %05zx:", i);
+		for (j = i; j < i + 16 && j < sizeof(trace); j++)
+			fprintf(out, " %02x", p[j]);
+		fprintf(out, "\n");
+	}
+
+	if (out != stdout)
+		fclose(out);
+}
+
+//* ************************************************************************************************
+/// @fn			sim_finish
+/// @brief		Stop the simulation and print statistics.
+/// @return		does not return
+//* ************************************************************************************************
+static void sim_finish(int status)
+{
+	if (sim_energy_report)
+		sim_energy_print(stdout);
+
+	if (sim_trace_path)
+		sim_trace_write(sim_trace_path);
+
+	fprintf(stderr, "sim: stopped at %.3fs, %lu sleeps, %.3fms host CPU awake (%.2fus per wakeup)\n",
+		sim_seconds(), sim_sleeps, sim_awake_host * 1e3,
+		sim_sleeps ? sim_awake_host * 1e6 / sim_sleeps : 0);
+	sim_vectors_print(stderr);
+
+	exit(status);
+}
+
+static void sim_fatal(const char *why)
+{
+	fprintf(stderr, "sim: %s at %.3fs\n", why, sim_seconds());
+	sim_finish(2);
+}
+
+
+// *************************************************************************************************
+// Timer_A
+
+static uint16_t sim_timer_top(const struct sim_timer *t)
+{
+	return (*t->ctl & MC_3) == MC__CONTINOUS ? 0xffff : *t->ccr[0];
+}
+
+/// Timer clock cycles at a given time, with the current clock settings
+static uint64_t sim_timer_clock(const struct sim_timer *t, uint64_t at, uint64_t *den, uint64_t *num)
+{
+	uint16_t ctl = *t->ctl;
+	uint64_t div = (1 << ((ctl >> 6) & 3)) * ((*t->ex0 & 7) + 1);
+
+	if ((ctl & TASSEL__INCLK) == TASSEL__SMCLK)
+	{
+		*num = SIM_SMCLK_NUM;
+		*den = SIM_SMCLK_DEN * div;
+	}
+	else
+	{
+		*num = 1;
+		*den = div;
+	}
+
+	return at * *num / *den;
+}
+
+/// Timer clock cycles until the counter next reaches a value
+static uint32_t sim_timer_distance(const struct sim_timer *t, uint16_t value)
+{
+	uint32_t period = (uint32_t)sim_timer_top(t) + 1;
+	uint32_t d;
+
+	if (value >= period)
+		return 0;
+
+	d = ((uint32_t)value + period - *t->r) % period;
+
+	return d ? d : period;
+}
+
+static void sim_timer_advance(struct sim_timer *t, uint64_t from, uint64_t to)
+{
+	uint64_t num, den, n;
+	uint32_t period, d;
+	uint8_t i;
+
+	if (!(*t->ctl & MC_3))
+		return;
+
+	n = sim_timer_clock(t, to, &den, &num) - sim_timer_clock(t, from, &den, &num);
+	if (!n)
+		return;
+
+	period = (uint32_t)sim_timer_top(t) + 1;
+
+	// Restarts from zero when CCR0 was moved below the counter
+	if (*t->r >= period)
+		*t->r = 0;
+
+	for (i = 0; i < t->ccrs; i++)
+	{
+		d = sim_timer_distance(t, *t->ccr[i]);
+
+		if (d && !(*t->cctl[i] & CAP) && n >= d)
+			*t->cctl[i] |= CCIFG;
+	}
+
+	if (n >= period - *t->r)
+		*t->ctl |= TAIFG;
+
+	*t->r = (*t->r + n) % period;
+}
+
+/// Time of the next enabled timer interrupt
+static uint64_t sim_timer_next(const struct sim_timer *t)
+{
+	uint64_t num, den, c;
+	uint32_t d, best = 0;
+	uint8_t i;
+
+	if (!(*t->ctl & MC_3))
+		return SIM_NEVER;
+
+	for (i = 0; i < t->ccrs; i++)
+	{
+		if ((*t->cctl[i] & (CCIE | CCIFG | CAP)) != CCIE)
+			continue;
+
+		d = sim_timer_distance(t, *t->ccr[i]);
+
+		if (d && (!best || d < best))
+			best = d;
+	}
+
+	if ((*t->ctl & (TAIE | TAIFG)) == TAIE)
+	{
+		d = (uint32_t)sim_timer_top(t) + 1 - *t->r;
+
+		if (!best || d < best)
+			best = d;
+	}
+
+	if (!best)
+		return SIM_NEVER;
+
+	c = sim_timer_clock(t, sim_now, &den, &num) + best;
+
+	return (c * den + num - 1) / num;
+}
+
+/// Highest pending interrupt of the CCR1+ and overflow vector, cleared
+static uint16_t sim_timer_iv(const struct sim_timer *t, uint8_t clear)
+{
+	uint8_t i;
+
+	for (i = 1; i < t->ccrs; i++)
+	{
+		if ((*t->cctl[i] & (CCIE | CCIFG)) == (CCIE | CCIFG))
+		{
+			if (clear)
+				*t->cctl[i] &= ~CCIFG;
+			return i * 2;
+		}
+	}
+
+	if ((*t->ctl & (TAIE | TAIFG)) == (TAIE | TAIFG))
+	{
+		if (clear)
+			*t->ctl &= ~TAIFG;
+		return 0x0e;
+	}
+
+	return 0;
+}
+
+
+// *************************************************************************************************
+// RTC_A
+
+static uint8_t sim_rtc_days(uint8_t mon, uint16_t year)
+{
+	static const uint8_t days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+	if (mon == 2 && !(year & 3) && (year % 100 || !(year % 400)))
+		return 29;
+
+	return (mon >= 1 && mon <= 12) ? days[mon - 1] : 31;
+}
+
+static uint8_t sim_rtc_running(void)
+{
+	return (RTCCTL01 & (RTCMODE | RTCHOLD)) == RTCMODE;
+}
+
+static void sim_rtc_alarm(void)
+{
+	uint8_t enabled = 0, match = 1;
+
+	if (RTCAMIN & RTCAE)
+	{
+		enabled = 1;
+		match &= (RTCAMIN & 0x7f) == RTCMIN;
+	}
+	if (RTCAHOUR & RTCAE)
+	{
+		enabled = 1;
+		match &= (RTCAHOUR & 0x7f) == RTCHOUR;
+	}
+	if (RTCADOW & RTCAE)
+	{
+		enabled = 1;
+		match &= (RTCADOW & 0x7f) == RTCDOW;
+	}
+	if (RTCADAY & RTCAE)
+	{
+		enabled = 1;
+		match &= (RTCADAY & 0x7f) == RTCDAY;
+	}
+
+	if (enabled && match)
+		RTCCTL01 |= RTCAIFG;
+}
+
+/// Value of a calendar register in binary, whatever the RTCBCD format
+static uint8_t sim_rtc_get(uint8_t reg)
+{
+	return (RTCCTL01 & RTCBCD) ? (reg >> 4) * 10 + (reg & 0x0f) : reg;
+}
+
+/// Binary value in the RTCBCD format of the calendar registers
+static uint8_t sim_rtc_put(uint8_t n)
+{
+	return (RTCCTL01 & RTCBCD) ? (n / 10) << 4 | n % 10 : n;
+}
+
+static uint16_t sim_rtc_get_year(void)
+{
+	if (RTCCTL01 & RTCBCD)
+		return sim_rtc_get(RTCYEARH) * 100 + sim_rtc_get(RTCYEARL);
+
+	return RTCYEAR;
+}
+
+static void sim_rtc_put_year(uint16_t year)
+{
+	if (RTCCTL01 & RTCBCD)
+	{
+		RTCYEARH = sim_rtc_put(year / 100);
+		RTCYEARL = sim_rtc_put(year % 100);
+	}
+	else
+		RTCYEAR = year;
+}
+
+static void sim_rtc_second(void)
+{
+	uint8_t tev = 0;
+	uint8_t sec = sim_rtc_get(RTCSEC) + 1;
+	uint8_t min, hour, day, mon;
+
+	RTCCTL01 |= RTCRDYIFG;
+
+	if (sec < 60)
+	{
+		RTCSEC = sim_rtc_put(sec);
+		return;
+	}
+
+	RTCSEC = 0;
+	min = sim_rtc_get(RTCMIN) + 1;
+
+	if (min >= 60)
+	{
+		RTCMIN = 0;
+		hour = sim_rtc_get(RTCHOUR) + 1;
+
+		if (hour >= 24)
+		{
+			RTCHOUR = 0;
+			RTCDOW = (RTCDOW + 1) % 7;
+			day = sim_rtc_get(RTCDAY) + 1;
+			mon = sim_rtc_get(RTCMON);
+
+			if (day > sim_rtc_days(mon, sim_rtc_get_year()))
+			{
+				RTCDAY = sim_rtc_put(1);
+
+				if (++mon > 12)
+				{
+					RTCMON = sim_rtc_put(1);
+					sim_rtc_put_year(sim_rtc_get_year() + 1);
+				}
+				else
+					RTCMON = sim_rtc_put(mon);
+			}
+			else
+				RTCDAY = sim_rtc_put(day);
+		}
+		else
+			RTCHOUR = sim_rtc_put(hour);
+
+		switch (RTCCTL01 & RTCTEV_3)
+		{
+			case RTCTEV_1:
+				tev = 1;
+				break;
+			case RTCTEV_2:
+				tev = (RTCHOUR == 0);
+				break;
+			case RTCTEV_3:
+				tev = (RTCHOUR == sim_rtc_put(12));
+				break;
+		}
+	}
+	else
+		RTCMIN = sim_rtc_put(min);
+
+	if ((RTCCTL01 & RTCTEV_3) == RTCTEV_0)
+		tev = 1;
+
+	if (tev)
+		RTCCTL01 |= RTCTEVIFG;
+
+	sim_rtc_alarm();
+}
+
+static void sim_rtc_advance(uint64_t from, uint64_t to)
+{
+	if (!sim_rtc_running())
+		return;
+
+	sim_rtc_phase += to - from;
+
+	while (sim_rtc_phase >= SIM_ACLK_HZ)
+	{
+		sim_rtc_phase -= SIM_ACLK_HZ;
+		sim_rtc_second();
+	}
+
+	// RT0PS counts ACLK, RT1PS counts RT0PS overflows
+	RTCPS0 = sim_rtc_phase & 0xff;
+	RTCPS1 = sim_rtc_phase >> 8;
+}
+
+/// Time of the next second that can raise an enabled interrupt
+static uint64_t sim_rtc_next(void)
+{
+	uint64_t next = sim_now + SIM_ACLK_HZ - sim_rtc_phase;
+	uint8_t sec;
+
+	if (!sim_rtc_running())
+		return SIM_NEVER;
+
+	if (RTCCTL01 & RTCRDYIE)
+		return next;
+
+	// time events and alarms happen on minute boundaries
+	if (!(RTCCTL01 & (RTCTEVIE | RTCAIE)))
+		return SIM_NEVER;
+
+	sec = sim_rtc_get(RTCSEC);
+
+	return next + (uint64_t)(sec < 59 ? 59 - sec : 0) * SIM_ACLK_HZ;
+}
+
+
+// *************************************************************************************************
+// Interrupt vectors
+
+static uint8_t sim_adc12_pending(void)
+{
+	return (ADC12IE & ADC12IFG) != 0;
+}
+
+static uint8_t sim_ta0_a0_pending(void)
+{
+	return (TA0CCTL0 & (CCIE | CCIFG)) == (CCIE | CCIFG);
+}
+
+static void sim_ta0_a0_ack(void)
+{
+	TA0CCTL0 &= ~CCIFG;
+}
+
+static uint8_t sim_ta0_a1_pending(void)
+{
+	return sim_timer_iv(&sim_ta0, 0) != 0;
+}
+
+static uint8_t sim_radio_pending(void)
+{
+	return (RF1AIE & RF1AIFG) != 0;
+}
+
+static uint8_t sim_ta1_a0_pending(void)
+{
+	return (TA1CCTL0 & (CCIE | CCIFG)) == (CCIE | CCIFG);
+}
+
+static void sim_ta1_a0_ack(void)
+{
+	TA1CCTL0 &= ~CCIFG;
+}
+
+static uint8_t sim_ta1_a1_pending(void)
+{
+	return sim_timer_iv(&sim_ta1, 0) != 0;
+}
+
+static uint8_t sim_port2_pending(void)
+{
+	return (P2IE & P2IFG) != 0;
+}
+
+static uint8_t sim_dma_pending(void)
+{
+	uint8_t ch;
+
+	for (ch = 0; ch < 3; ch++)
+	{
+		if ((sim_dma_ctl[ch] & (DMAIE | DMAIFG)) == (DMAIE | DMAIFG))
+			return 1;
+	}
+
+	return 0;
+}
+
+static uint8_t sim_rtc_pending(void)
+{
+	return ((RTCCTL01 >> 4) & RTCCTL01 & (RTCTEVIFG | RTCAIFG | RTCRDYIFG)) != 0;
+}
+
+/// Interrupt vectors, highest priority first
+static struct sim_vector sim_vectors[] = {
+	{"ADC12", sim_adc12_pending, NULL, ADC12ISR},
+	{"TA0CCR0", sim_ta0_a0_pending, sim_ta0_a0_ack, timer0_A0_ISR},
+	{"TA0", sim_ta0_a1_pending, NULL, timer0_A1_ISR},
+	{"RADIO", sim_radio_pending, NULL, radio_ISR},
+	{"DMA", sim_dma_pending, NULL, DMA_ISR},
+	{"TA1CCR0", sim_ta1_a0_pending, sim_ta1_a0_ack, NULL},
+	{"TA1", sim_ta1_a1_pending, NULL, prof_TA1_ISR},
+	{"PORT2", sim_port2_pending, NULL, PORT2_ISR},
+	{"RTC", sim_rtc_pending, NULL, RTC_A_ISR},
+};
+
+#define SIM_VECTORS	(sizeof(sim_vectors) / sizeof(sim_vectors[0]))
+
+static unsigned long sim_interrupts(void)
+{
+	unsigned long n = 0;
+	uint8_t i;
+
+	for (i = 0; i < SIM_VECTORS; i++)
+		n += sim_vectors[i].count;
+
+	return n;
+}
+
+static void sim_vectors_print(FILE *out)
+{
+	uint8_t i;
+
+	fprintf(out, "sim: interrupts");
+
+	for (i = 0; i < SIM_VECTORS; i++)
+	{
+		if (sim_vectors[i].count)
+			fprintf(out, " %s=%lu", sim_vectors[i].name, sim_vectors[i].count);
+	}
+
+	fprintf(out, "\n");
+}
+
+volatile uint16_t *sim_ta0iv(void)
+{
+	sim_iv = sim_timer_iv(&sim_ta0, 1);
+	return &sim_iv;
+}
+
+volatile uint16_t *sim_ta1iv(void)
+{
+	sim_iv = sim_timer_iv(&sim_ta1, 1);
+	return &sim_iv;
+}
+
+volatile uint16_t *sim_rtciv(void)
+{
+	uint8_t pending = (RTCCTL01 >> 4) & RTCCTL01;
+
+	sim_iv = 0;
+
+	if (pending & RTCRDYIFG)
+	{
+		RTCCTL01 &= ~RTCRDYIFG;
+		sim_iv = RTCIV_RTCRDYIFG;
+	}
+	else if (pending & RTCTEVIFG)
+	{
+		RTCCTL01 &= ~RTCTEVIFG;
+		sim_iv = RTCIV_RTCTEVIFG;
+	}
+	else if (pending & RTCAIFG)
+	{
+		RTCCTL01 &= ~RTCAIFG;
+		sim_iv = RTCIV_RTCAIFG;
+	}
+
+	return &sim_iv;
+}
+
+volatile uint16_t *sim_p2iv(void)
+{
+	uint8_t pending = P2IE & P2IFG;
+	uint8_t i;
+
+	sim_iv = 0;
+
+	for (i = 0; i < 8; i++)
+	{
+		if (pending & (1 << i))
+		{
+			P2IFG &= ~(1 << i);
+			sim_iv = (i + 1) * 2;
+			break;
+		}
+	}
+
+	return &sim_iv;
+}
+
+volatile uint16_t *sim_adc12iv(void)
+{
+	sim_iv = 0;
+
+	if (ADC12IE & ADC12IFG & BIT0)
+	{
+		ADC12IFG &= ~BIT0;
+		sim_iv = 6;
+	}
+
+	return &sim_iv;
+}
+
+volatile uint16_t *sim_rf1aiv(void)
+{
+	sim_iv = 0;
+	return &sim_iv;
+}
+
+volatile uint16_t *sim_rf1aifctl1(void)
+{
+	static volatile uint16_t ifctl1;
+
+	ifctl1 |= RFSTATIFG | RFDOUTIFG | RFINSTRIFG | RFDINIFG;
+	return &ifctl1;
+}
+
+volatile uint16_t *sim_dmaiv(void)
+{
+	uint8_t ch;
+
+	sim_iv = 0;
+
+	for (ch = 0; ch < 3; ch++)
+	{
+		if ((sim_dma_ctl[ch] & (DMAIE | DMAIFG)) == (DMAIE | DMAIFG))
+		{
+			sim_dma_ctl[ch] &= ~DMAIFG;
+			sim_iv = (ch + 1) * 2;
+			break;
+		}
+	}
+
+	return &sim_iv;
+}
+
+//* ************************************************************************************************
+/// @fn			sim_dma_run
+/// @brief		Do the transfers requested by software, a whole block (or a single unit) at once.
+/// @return		none
+//* ************************************************************************************************
+static void sim_dma_run(void)
+{
+	uint8_t ch;
+
+	for (ch = 0; ch < 3; ch++)
+	{
+		uint16_t ctl = sim_dma_ctl[ch];
+		uint8_t *src = (uint8_t *)*sim_dma_sa[ch];
+		uint8_t *dst = (uint8_t *)*sim_dma_da[ch];
+		uint16_t n = (ctl & DMADT_1) ? *sim_dma_sz[ch] : 1;
+
+		if ((ctl & (DMAEN | DMAREQ)) != (DMAEN | DMAREQ))
+			continue;
+
+		for (; n; n--)
+		{
+			*dst = *src;
+
+			if (!(ctl & DMADSTBYTE) && !(ctl & DMASRCBYTE))
+				dst[1] = src[1];
+
+			if ((ctl & DMASRCINCR_3) == DMASRCINCR_3)
+				src += (ctl & DMASRCBYTE) ? 1 : 2;
+			else if ((ctl & DMASRCINCR_3) == DMASRCINCR_2)
+				src -= (ctl & DMASRCBYTE) ? 1 : 2;
+
+			if ((ctl & DMADSTINCR_3) == DMADSTINCR_3)
+				dst += (ctl & DMADSTBYTE) ? 1 : 2;
+			else if ((ctl & DMADSTINCR_3) == DMADSTINCR_2)
+				dst -= (ctl & DMADSTBYTE) ? 1 : 2;
+		}
+
+		sim_dma_ctl[ch] = (ctl & ~(DMAEN | DMAREQ)) | DMAIFG;
+	}
+}
+
+volatile uint16_t *sim_dmactl(uint8_t ch)
+{
+	sim_dma_run();
+	return &sim_dma_ctl[ch];
+}
+
+//* ************************************************************************************************
+/// @fn			sim_dispatch
+/// @brief		Service the pending interrupts while they are enabled.
+/// @return		none
+//* ************************************************************************************************
+static void sim_dispatch(void)
+{
+	uint8_t i;
+
+	while (sim_sr & GIE)
+	{
+		for (i = 0; i < SIM_VECTORS; i++)
+		{
+			if (sim_vectors[i].pending())
+				break;
+		}
+
+		if (i == SIM_VECTORS)
+			return;
+
+		if (!sim_vectors[i].isr)
+		{
+			fprintf(stderr, "sim: no interrupt routine for %s\n", sim_vectors[i].name);
+			sim_fatal("unhandled interrupt");
+		}
+
+		if (++sim_storm > SIM_STORM)
+			sim_fatal("interrupt storm");
+
+		if (sim_depth == sizeof(sim_sr_saved) / sizeof(sim_sr_saved[0]))
+			sim_fatal("interrupts nested too deep");
+
+		// The CPU saves SR and clears it, except SCG0
+		sim_sr_saved[sim_depth++] = sim_sr;
+		sim_sr &= SCG0;
+
+		if (sim_vectors[i].ack)
+			sim_vectors[i].ack();
+
+		sim_vectors[i].count++;
+		sim_vectors[i].isr();
+
+		// RETI
+		sim_sr = sim_sr_saved[--sim_depth];
+	}
+}
+
+
+// *************************************************************************************************
+// Time
+
+/// Watchdog interval in ACLK cycles, SIM_NEVER when it cannot reset
+static uint64_t sim_wdt_period(void)
+{
+	static const uint8_t bits[8] = {31, 27, 23, 19, 15, 13, 9, 6};
+
+	if (WDTCTL & (WDTHOLD | WDTTMSEL))
+		return SIM_NEVER;
+
+	return (uint64_t)1 << bits[WDTCTL & 7];
+}
+
+//* ************************************************************************************************
+/// @fn			sim_sync
+/// @brief		Apply the register writes the peripherals react to.
+/// @return		none
+//* ************************************************************************************************
+static void sim_sync(void)
+{
+	uint64_t period;
+
+	if (TA0CTL & TACLR)
+	{
+		TA0R = 0;
+		TA0CTL &= ~TACLR;
+	}
+
+	if (TA1CTL & TACLR)
+	{
+		TA1R = 0;
+		TA1CTL &= ~TACLR;
+	}
+
+	// Conversions are instantaneous
+	if ((ADC12CTL0 & (ADC12ON | ADC12ENC | ADC12SC)) == (ADC12ON | ADC12ENC | ADC12SC))
+	{
+		ADC12MEM0 = sim_adc[ADC12MCTL0 & 0x0f];
+		ADC12IFG |= BIT0;
+		ADC12CTL0 &= ~ADC12SC;
+	}
+
+	sim_dma_run();
+
+	if (LCDBMEMCTL & LCDCLRM)
+	{
+		memset(sim_lcdmem, 0, 0x20);
+		LCDBMEMCTL &= ~LCDCLRM;
+	}
+
+	if (LCDBMEMCTL & LCDCLRBM)
+	{
+		memset(sim_lcdmem + 0x20, 0, 0x20);
+		LCDBMEMCTL &= ~LCDCLRBM;
+	}
+
+	// The last instruction given to the radio core tells its state
+	switch (RF1AINSTRB)
+	{
+		case RF_SRX:
+			sim_radio = SIM_RADIO_RX;
+			break;
+		case RF_STX:
+			sim_radio = SIM_RADIO_TX;
+			break;
+		case RF_SRES:
+		case RF_SIDLE:
+		case RF_SPWD:
+		case RF_SXOFF:
+			sim_radio = SIM_RADIO_OFF;
+			break;
+	}
+
+	if (WDTCTL & WDTCNTCL)
+	{
+		sim_wdt_cleared = sim_now;
+		WDTCTL &= ~WDTCNTCL;
+	}
+
+	period = sim_wdt_period();
+
+	if (period != SIM_NEVER && sim_now - sim_wdt_cleared >= period)
+		sim_fatal("watchdog reset");
+}
+
+static void sim_button(uint8_t pin, uint8_t pressed)
+{
+	// Edge select: 0 rising, 1 falling
+	if (pressed && !(P2IN & pin))
+	{
+		P2IN |= pin;
+		if (!(P2IES & pin))
+			P2IFG |= pin;
+	}
+	else if (!pressed && (P2IN & pin))
+	{
+		P2IN &= ~pin;
+		if (P2IES & pin)
+			P2IFG |= pin;
+	}
+}
+
+static void sim_click(uint64_t at, uint8_t pin)
+{
+	sim_script_add(at, SIM_PRESS, pin, 0);
+	sim_script_add(at + SIM_TICKS(0.1), SIM_RELEASE, pin, 0);
+}
+
+//* ************************************************************************************************
+/// @fn			sim_goto_step
+/// @brief		Walk the menu until it shows an entry, one UP click at a time.
+/// @return		none
+//* ************************************************************************************************
+static void sim_goto_step(const char *text, uint16_t tries)
+{
+	static char first[8];
+	struct sim_event *ev;
+
+	if (sim_lcd_shows(text))
+	{
+		sim_click(sim_now, SIM_BTN_STAR);
+		return;
+	}
+
+	if (!tries)
+		sim_lcd_line2(first);
+	else if (sim_lcd_shows(first) || tries > SIM_GOTO_TRIES)
+	{
+		// Back where we started, leave the menu
+		fprintf(stderr, "sim: no menu entry \"%s\" at %.3fs\n", text, sim_seconds());
+		sim_click(sim_now, SIM_BTN_STAR);
+		return;
+	}
+
+	sim_click(sim_now, SIM_BTN_UP);
+
+	ev = sim_script_add(sim_now + SIM_TICKS(0.5), SIM_GOTO_STEP, tries + 1, 0);
+	strcpy(ev->text, text);
+}
+
+static void sim_script_run(void)
+{
+	struct sim_event *ev;
+	char text[8];
+
+	while (sim_script_next < sim_script_len && sim_script[sim_script_next].at <= sim_now)
+	{
+		ev = &sim_script[sim_script_next++];
+
+		switch (ev->cmd)
+		{
+			case SIM_PRESS:
+				sim_button(ev->arg, 1);
+				break;
+			case SIM_RELEASE:
+				sim_button(ev->arg, 0);
+				break;
+			case SIM_ADC:
+				sim_adc[ev->arg & 0x0f] = ev->value;
+				break;
+			case SIM_LCD:
+				printf("%10.3f  ", sim_seconds());
+				sim_lcd_print(stdout);
+				break;
+			case SIM_GOTO:
+				// STAR opens the menu, give it time to show up
+				sim_click(sim_now, SIM_BTN_STAR);
+				ev = sim_script_add(sim_now + SIM_TICKS(0.5), SIM_GOTO_STEP, 0, 0);
+				strcpy(ev->text, sim_script[sim_script_next - 1].text);
+				break;
+			case SIM_GOTO_STEP:
+				// adding events moves them around
+				strcpy(text, ev->text);
+				sim_goto_step(text, ev->arg);
+				break;
+			case SIM_QUIT:
+				sim_finish(0);
+				break;
+		}
+	}
+}
+
+static uint64_t sim_next_event(void)
+{
+	uint64_t next = sim_timer_next(&sim_ta0);
+	uint64_t t;
+
+	t = sim_timer_next(&sim_ta1);
+	if (t < next)
+		next = t;
+
+	t = sim_rtc_next();
+	if (t < next)
+		next = t;
+
+	t = sim_wdt_period();
+	if (t != SIM_NEVER && sim_wdt_cleared + t < next)
+		next = sim_wdt_cleared + t;
+
+	if (sim_script_next < sim_script_len && sim_script[sim_script_next].at < next)
+		next = sim_script[sim_script_next].at;
+
+	return next;
+}
+
+/// Charge a time interval to the power states the hardware is in
+static void sim_energy_account(uint64_t ticks)
+{
+	if (!(sim_sr & CPUOFF))
+		sim_energy.active += ticks;
+	else if (sim_sr & SCG1)
+		sim_energy.lpm3 += ticks;
+	else
+		sim_energy.lpm1 += ticks;
+
+	if (LCDBCTL0 & LCDON)
+	{
+		sim_energy.lcd += ticks;
+		if (LCDBVCTL & LCDCPEN)
+			sim_energy.lcd_pump += ticks;
+	}
+
+	if (ADC12CTL0 & ADC12ON)
+		sim_energy.adc += ticks;
+
+	if (REFCTL0 & REFON)
+		sim_energy.ref += ticks;
+
+	// The buzzer is driven by TA1 output on P2.7
+	if ((P2SEL & BIT7) && (TA1CTL & MC_3))
+		sim_energy.buzzer += ticks;
+
+	if (sim_radio == SIM_RADIO_RX)
+		sim_energy.radio_rx += ticks;
+	else if (sim_radio == SIM_RADIO_TX)
+		sim_energy.radio_tx += ticks;
+}
+
+//* ************************************************************************************************
+/// @fn			sim_advance
+/// @brief		Move simulated time forward, up to the next event.
+/// @return		none
+//* ************************************************************************************************
+static void sim_advance(uint64_t to)
+{
+	if (to > sim_end)
+	{
+		sim_now = sim_end;
+		sim_finish(0);
+	}
+
+	sim_energy_account(to - sim_now);
+
+	sim_timer_advance(&sim_ta0, sim_now, to);
+	sim_timer_advance(&sim_ta1, sim_now, to);
+	sim_rtc_advance(sim_now, to);
+
+	if (to != sim_now)
+		sim_storm = 0;
+
+	sim_now = to;
+
+	sim_script_run();
+	sim_sync();
+}
+
+static void sim_sleep(void)
+{
+	uint64_t next;
+
+	sim_asleep();
+	sim_sleeps++;
+
+	if (sim_verbose && sim_lcd_changed())
+	{
+		printf("%10.3f  ", sim_seconds());
+		sim_lcd_print(stdout);
+	}
+
+	while (sim_sr & CPUOFF)
+	{
+		if (!(sim_sr & GIE))
+			sim_fatal("sleeping with interrupts disabled");
+
+		next = sim_next_event();
+
+		if (next == SIM_NEVER)
+			sim_fatal("nothing left to wake up the CPU");
+
+		sim_advance(next);
+		sim_dispatch();
+	}
+
+	sim_awake();
+}
+
+
+// *************************************************************************************************
+// Status register and intrinsics
+
+void sim_bis_sr(uint16_t bits)
+{
+	sim_write_sr(sim_sr | bits);
+}
+
+void sim_bic_sr(uint16_t bits)
+{
+	sim_write_sr(sim_sr & ~bits);
+}
+
+void sim_bis_sr_irq(uint16_t bits)
+{
+	if (sim_depth)
+		sim_sr_saved[sim_depth - 1] |= bits;
+	else
+		sim_bis_sr(bits);
+}
+
+void sim_bic_sr_irq(uint16_t bits)
+{
+	if (sim_depth)
+		sim_sr_saved[sim_depth - 1] &= ~bits;
+	else
+		sim_bic_sr(bits);
+}
+
+uint16_t sim_read_sr(void)
+{
+	return sim_sr;
+}
+
+void sim_write_sr(uint16_t sr)
+{
+	sim_sr = sr;
+
+	sim_sync();
+	sim_dispatch();
+
+	if (sim_sr & CPUOFF)
+		sim_sleep();
+}
+
+void sim_delay_cycles(uint32_t cycles)
+{
+	uint64_t to, next;
+
+	sim_energy.delay_cycles += cycles;
+	sim_mclk_frac += (uint64_t)cycles * SIM_SMCLK_DEN;
+	to = sim_now + sim_mclk_frac / SIM_SMCLK_NUM;
+	sim_mclk_frac %= SIM_SMCLK_NUM;
+
+	while (sim_now < to)
+	{
+		next = sim_next_event();
+		sim_advance(next < to ? next : to);
+		sim_dispatch();
+	}
+}
+
+
+/// Replaces core/even_in_range.s
+unsigned short __even_in_range(unsigned short value, unsigned short bound)
+{
+	return ((value & 1) || value > bound) ? 0 : value;
+}
+
+
+// *************************************************************************************************
+// Script and entry point
+
+static int sim_script_button(const char *name)
+{
+	if (!strcmp(name, "star"))
+		return SIM_BTN_STAR;
+	if (!strcmp(name, "num"))
+		return SIM_BTN_NUM;
+	if (!strcmp(name, "up"))
+		return SIM_BTN_UP;
+	if (!strcmp(name, "down"))
+		return SIM_BTN_DOWN;
+	if (!strcmp(name, "backlight"))
+		return SIM_BTN_BL;
+	return -1;
+}
+
+static struct sim_event *sim_script_add(uint64_t at, enum sim_command cmd, uint16_t arg, uint16_t value)
+{
+	struct sim_event *ev;
+	unsigned i;
+
+	// Drop the events already run
+	if (sim_script_len == SIM_SCRIPT_SIZE && sim_script_next)
+	{
+		memmove(sim_script, sim_script + sim_script_next,
+			(sim_script_len - sim_script_next) * sizeof(sim_script[0]));
+		sim_script_len -= sim_script_next;
+		sim_script_next = 0;
+	}
+
+	if (sim_script_len == SIM_SCRIPT_SIZE)
+	{
+		fprintf(stderr, "sim: script too long\n");
+		exit(1);
+	}
+
+	// Keep the script sorted, events at the same time keep their order
+	for (i = sim_script_len; i > 0 && sim_script[i - 1].at > at; i--)
+		sim_script[i] = sim_script[i - 1];
+
+	ev = &sim_script[i];
+	ev->at = at;
+	ev->cmd = cmd;
+	ev->arg = arg;
+	ev->value = value;
+	ev->text[0] = '\0';
+	sim_script_len++;
+
+	return ev;
+}
+
+static void sim_script_load(const char *path)
+{
+	FILE *f = strcmp(path, "-") ? fopen(path, "r") : stdin;
+	char line[256], when[32], cmd[32], arg[32], *text;
+	double t = 0, secs;
+	unsigned lineno = 0, value;
+	int btn, n;
+
+	if (!f)
+	{
+		perror(path);
+		exit(1);
+	}
+
+	while (fgets(line, sizeof(line), f))
+	{
+		lineno++;
+
+		n = sscanf(line, "%31s %31s %31s %u", when, cmd, arg, &value);
+
+		if (n <= 0 || when[0] == '#')
+			continue;
+
+		if (n < 2)
+			goto error;
+
+		t = (when[0] == '+') ? t + atof(when + 1) : atof(when);
+		btn = (n >= 3) ? sim_script_button(arg) : -1;
+
+		if (!strcmp(cmd, "press") && btn > 0)
+			sim_script_add(SIM_TICKS(t), SIM_PRESS, btn, 0);
+		else if (!strcmp(cmd, "release") && btn > 0)
+			sim_script_add(SIM_TICKS(t), SIM_RELEASE, btn, 0);
+		else if (!strcmp(cmd, "click") && btn > 0)
+		{
+			sim_script_add(SIM_TICKS(t), SIM_PRESS, btn, 0);
+			sim_script_add(SIM_TICKS(t + 0.1), SIM_RELEASE, btn, 0);
+		}
+		else if (!strcmp(cmd, "hold") && btn > 0)
+		{
+			// the duration may have a fraction, read it again
+			if (sscanf(line, "%*s %*s %*s %lf", &secs) != 1)
+				goto error;
+			sim_script_add(SIM_TICKS(t), SIM_PRESS, btn, 0);
+			sim_script_add(SIM_TICKS(t + secs), SIM_RELEASE, btn, 0);
+		}
+		else if (!strcmp(cmd, "adc") && n == 4)
+			sim_script_add(SIM_TICKS(t), SIM_ADC, atoi(arg), value);
+		else if (!strcmp(cmd, "goto") && n >= 3)
+		{
+			// the menu entry may have spaces, take the rest of the line
+			text = strstr(line, cmd) + strlen(cmd);
+			text += strspn(text, " \t");
+			text[strcspn(text, "#\r\n")] = '\0';
+			while (strlen(text) && text[strlen(text) - 1] == ' ')
+				text[strlen(text) - 1] = '\0';
+			snprintf(sim_script_add(SIM_TICKS(t), SIM_GOTO, 0, 0)->text, 8, "%s", text);
+		}
+		else if (!strcmp(cmd, "lcd"))
+			sim_script_add(SIM_TICKS(t), SIM_LCD, 0, 0);
+		else if (!strcmp(cmd, "quit"))
+			sim_script_add(SIM_TICKS(t), SIM_QUIT, 0, 0);
+		else
+			goto error;
+	}
+
+	if (f != stdin)
+		fclose(f);
+
+	return;
+
+error:
+	fprintf(stderr, "%s:%u: cannot parse: %s", path, lineno, line);
+	exit(1);
+}
+
+//* ************************************************************************************************
+/// @fn			sim_check_rtca
+/// @brief		Compare rtca_from_epoch() and rtca_mktime() with gmtime() for every day of 2000
+///				to 2099, at a few times of the day.
+/// @return		Number of mismatches
+//* ************************************************************************************************
+static unsigned sim_check_rtca(void)
+{
+	static const uint32_t sods[] = { 0, 1, 59, 60, 3599, 3600, 43210, 86340, 86399 };
+	unsigned bad = 0, i;
+	uint32_t day, epoch;
+	struct rtca_tm tm;
+	struct tm *ref;
+	time_t t;
+
+	for (day = 0; day < 36525; day++)
+	{
+		for (i = 0; i < sizeof(sods) / sizeof(sods[0]); i++)
+		{
+			epoch = RTCA_EPOCH_2000 + day * 86400 + sods[i];
+			t = epoch;
+			ref = gmtime(&t);
+			rtca_from_epoch(epoch, &tm);
+
+			if (tm.year != ref->tm_year + 1900 || tm.mon != ref->tm_mon + 1
+				|| tm.day != ref->tm_mday || tm.dow != ref->tm_wday
+				|| tm.hour != ref->tm_hour || tm.min != ref->tm_min
+				|| tm.sec != ref->tm_sec
+				|| rtca_mktime(tm.year, tm.mon, tm.day, tm.hour, tm.min, tm.sec) != epoch)
+			{
+				if (bad++ < 10)
+					fprintf(stderr, "sim: %lu is %04u-%02u-%02u (%u) %02u:%02u:%02u\n",
+						(unsigned long)epoch, tm.year, tm.mon, tm.day, tm.dow,
+						tm.hour, tm.min, tm.sec);
+			}
+		}
+	}
+
+	printf("sim: %u calendar conversion mismatches\n", bad);
+
+	return bad;
+}
+
+static void sim_usage(const char *argv0)
+{
+	fprintf(stderr,
+		"usage: %s [-e] [-q] [-t seconds] [-T file] [script|-]\n"
+		"       %s -C\n"
+		"  -C          check the calendar conversions of drivers/rtca.c and exit\n"
+		"  -e          print the time spent in each power state at the end\n"
+		"  -q          do not print the display when it changes\n"
+		"  -t seconds  stop after this much simulated time (default: 10s after\n"
+		"              the last script event)\n"
+		"  -T file     write the event trace (CONFIG_TRACE) at the end, '-' for\n"
+		"              stdout, see tools/trace/trace.py\n",
+		argv0, argv0);
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	int opt;
+
+	while ((opt = getopt(argc, argv, "Ceqt:T:h")) != -1)
+	{
+		switch (opt)
+		{
+			case 'C':
+				return sim_check_rtca() ? 1 : 0;
+			case 'e':
+				sim_energy_report = 1;
+				break;
+			case 'q':
+				sim_verbose = 0;
+				break;
+			case 't':
+				sim_end = SIM_TICKS(atof(optarg));
+				break;
+			case 'T':
+				sim_trace_path = optarg;
+				break;
+			default:
+				sim_usage(argv[0]);
+		}
+	}
+
+	if (optind < argc)
+		sim_script_load(argv[optind]);
+
+	if (sim_end == SIM_NEVER)
+		sim_end = (sim_script_len ? sim_script[sim_script_len - 1].at : 0) + SIM_TICKS(10);
+
+	setvbuf(stdout, NULL, _IOLBF, 0);
+
+	sim_awake();
+
+	sim_stack_top = __builtin_frame_address(0);
+	sim_stack_bottom = sim_stack_top - SIM_STACK_WORDS;
+
+	return firmware_main();
+}
@@ -0,0 +1,61 @@
+/**
+	@file	host/sim.h
+	@brief	Host simulation internals
+
+	@see		http://www.openchronos-ng.sourceforge.net
+	@copyright
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __HOST_SIM_H__
+#define __HOST_SIM_H__
+
+// *************************************************************************************************
+// Include section
+
+#include <stdio.h>
+#include <msp430.h>
+
+
+// *************************************************************************************************
+// Defines section
+
+/// Simulated time unit, one ACLK cycle
+#define SIM_ACLK_HZ		32768
+
+/// SMCLK (and MCLK) is 12MHz, 46875/128 cycles per ACLK cycle
+#define SIM_SMCLK_NUM	46875
+#define SIM_SMCLK_DEN	128
+
+
+// *************************************************************************************************
+// Prototypes section
+
+/// The firmware entry point, the firmware is built with -Dmain=firmware_main.
+int firmware_main(void);
+
+/// Check if the LCD memory changed since the last sim_lcd_print().
+int sim_lcd_changed(void);
+
+/// Decode the second LCD line, 7 characters with the terminating zero.
+void sim_lcd_line2(char *text);
+
+/// Check if the second LCD line shows a text, in the way the display can show it.
+int sim_lcd_shows(const char *text);
+
+/// Print both LCD lines and the symbols that are on.
+void sim_lcd_print(FILE *out);
+
+#endif /* __HOST_SIM_H__ */
@@ -204,7 +204,7 @@ static void up_btn()
 			break;
 
 		case VIEW_SET_PARAMS:
-			_printf(0,LCD_SEG_L1_3_0 , "%04x", as_read_register(ADDR_CTRL));
+			display_number(0, LCD_SEG_L1_3_0, as_read_register(ADDR_CTRL), NUM_HEX | 4, SEG_SET);
 			break;
 
 		case VIEW_STATUS:
@@ -466,6 +466,16 @@ static void acc_deactivated()
 
 
 
+const struct menu mod_accelerometer_menu = {
+	.name = "ACC",
+	.up_btn_fn = &up_btn,
+	.down_btn_fn = &down_btn,
+	.num_btn_fn = &num_pressed,
+	.lstar_btn_fn = &star_long_pressed,
+	.activate_fn = &acc_activated,
+	.deactivate_fn = &acc_deactivated,
+};
+
 void mod_accelerometer_init()
 {
 
@@ -477,12 +487,4 @@ void mod_accelerometer_init()
 	sAccel.timeout = ACCEL_MEASUREMENT_TIMEOUT;
 	/* Clear mode */
 	sAccel.mode = ACCEL_MODE_OFF;
-
-	menu_add_entry("ACC",&up_btn, &down_btn,
-			&num_pressed,
-			&star_long_pressed,
-			NULL,NULL,
-			&acc_activated,
-			&acc_deactivated);
-
 }
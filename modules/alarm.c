@@ -20,34 +20,84 @@
  */
 
 #include <core/openchronos.h>
+#include <core/alarms.h>
 
 /* driver */
 #include <drivers/display.h>
 #include <drivers/rtca.h>
+#include <drivers/buzzer.h>
+
+/* UP and DOWN browse the alarm table, NUM turns the shown alarm on or off
+  and a long STAR edits its time and when it rings. The alarms are kept
+  and programmed into the RTC by core/alarms.c, this module only listens
+  to SYS_MSG_ALARM to ring the buzzer */
+
+/* what an alarm can be set to, in edit mode order */
+static const struct {
+	char name[5];
+	uint8_t flags;
+	uint8_t days;
+} alarm_modes[] = {
+	{ "ONCE", 0, ALARM_EVERYDAY },
+	{ "DALY", ALARM_REPEAT, ALARM_EVERYDAY },
+	{ "WORK", ALARM_REPEAT, ALARM_WORKDAYS },
+	{ "WEND", ALARM_REPEAT, ALARM_WEEKEND },
+};
+
+#define ALARM_MODES (sizeof(alarm_modes) / sizeof(alarm_modes[0]))
+
+/* beep four times */
+static note alarm_ring[] = {0x25a8, 0x1900, 0x25a8, 0x1900, 0x25a8, 0x1900, 0x25a8, 0x000F};
 
-static union {
-	struct {
-		/* one shot alarm */
-		uint8_t alarm:1;
-		/* hourly chime */
-		uint8_t chime:1;
-	};
-	uint8_t state:2;
-} alarm_state;
+/* shown alarm */
+static uint8_t alarm_nr;
+
+/* alarm being edited */
+static struct alarm tmp_alarm;
+static uint8_t tmp_mode;
+
+/* mode of an alarm, ALARM_MODES if it was not set by this module */
+static uint8_t alarm_mode(const struct alarm *alarm)
+{
+	uint8_t i = 0;
 
-static uint8_t tmp_hh, tmp_mm;
+	for (; i < ALARM_MODES; i++) {
+		if (alarm_modes[i].days == alarm->days
+		    && alarm_modes[i].flags == (alarm->flags & ALARM_REPEAT))
+			break;
+	}
+
+	return i;
+}
+
+static void display_mode(uint8_t mode, uint8_t on)
+{
+	if (!on)
+		display_chars(0, LCD_SEG_L2_3_0, "OFF ", SEG_SET);
+	else if (mode < ALARM_MODES)
+		display_chars(0, LCD_SEG_L2_3_0, alarm_modes[mode].name, SEG_SET);
+	else
+		display_chars(0, LCD_SEG_L2_3_0, "----", SEG_SET);
+}
 
 static void refresh_screen()
 {
-	rtca_get_alarm(&tmp_hh, &tmp_mm);
+	const struct alarm *alarm = alarms_get(alarm_nr);
+
+	display_number(0, LCD_SEG_L1_1_0, alarm->min, 2, SEG_SET);
+	display_number(0, LCD_SEG_L1_3_2, alarm->hour, 2, SEG_SET);
+	display_char(0, LCD_SEG_L2_4, '1' + alarm_nr, SEG_SET);
+	display_mode(alarm_mode(alarm), alarm->flags & ALARM_ON);
 
-	_printf(0, LCD_SEG_L1_1_0, "%02u", tmp_mm);
-	_printf(0, LCD_SEG_L1_3_2, "%02u", tmp_hh);
+	display_symbol(0, LCD_ICON_ALARM, alarms_armed() ? SEG_ON : SEG_OFF);
 }
 
 static void alarm_event(enum sys_message msg)
 {
-	/* TODO: */
+	buzzer_play(alarm_ring);
+
+	/* one-shot alarms turned off */
+	display_symbol(0, LCD_ICON_ALARM, alarms_armed() ? SEG_ON : SEG_OFF);
 }
 
 /*************************** edit mode callbacks **************************/
@@ -64,8 +114,8 @@ static void edit_hh_dsel(void)
 static void edit_hh_set(int8_t step)
 {
 	/* TODO: fix for 12/24 hr! */
-	helpers_loop(&tmp_hh, 0, 23, step);
-	_printf(0, LCD_SEG_L1_3_2, "%02u", tmp_hh);
+	helpers_loop(&tmp_alarm.hour, 0, 23, step);
+	display_number(0, LCD_SEG_L1_3_2, tmp_alarm.hour, 2, SEG_SET);
 }
 
 static void edit_mm_sel(void)
@@ -80,20 +130,43 @@ static void edit_mm_dsel(void)
 
 static void edit_mm_set(int8_t step)
 {
-	helpers_loop(&tmp_mm, 0, 59, step);
-	_printf(0, LCD_SEG_L1_1_0, "%02u", tmp_mm);
+	helpers_loop(&tmp_alarm.min, 0, 59, step);
+	display_number(0, LCD_SEG_L1_1_0, tmp_alarm.min, 2, SEG_SET);
+}
+
+static void edit_mode_sel(void)
+{
+	display_mode(tmp_mode, 1);
+	display_chars(0, LCD_SEG_L2_3_0, NULL, BLINK_ON);
+}
+
+static void edit_mode_dsel(void)
+{
+	display_chars(0, LCD_SEG_L2_3_0, NULL, BLINK_OFF);
+}
+
+static void edit_mode_set(int8_t step)
+{
+	helpers_loop(&tmp_mode, 0, ALARM_MODES - 1, step);
+	display_mode(tmp_mode, 1);
 }
 
 static void edit_save(void)
 {
 	/* Here we return from the edit mode, fill in the new values! */
-	rtca_set_alarm(tmp_hh, tmp_mm);
+	tmp_alarm.days = alarm_modes[tmp_mode].days;
+	tmp_alarm.flags = alarm_modes[tmp_mode].flags | ALARM_ON;
+
+	alarms_set(alarm_nr, &tmp_alarm);
+
+	refresh_screen();
 }
 
 /* edit mode item table */
 static struct menu_editmode_item edit_items[] = {
 	{&edit_hh_sel, &edit_hh_dsel, &edit_hh_set},
 	{&edit_mm_sel, &edit_mm_dsel, &edit_mm_set},
+	{&edit_mode_sel, &edit_mode_dsel, &edit_mode_set},
 	{ NULL },
 };
 
@@ -110,57 +183,66 @@ static void alarm_deactivated()
 {
 	/* clean up screen */
 	display_clear(0, 1);
+	display_clear(0, 2);
+}
+
+
+/* UP and DOWN buttons browse the alarms */
+static void up_pressed()
+{
+	helpers_loop(&alarm_nr, 0, ALARMS_COUNT - 1, 1);
+	refresh_screen();
+}
+
+static void down_pressed()
+{
+	helpers_loop(&alarm_nr, 0, ALARMS_COUNT - 1, -1);
+	refresh_screen();
 }
 
 
 /* NUM (#) button pressed callback */
 static void num_pressed()
 {
-	/* this cycles between all alarm/chime combinations and overflow */
-	alarm_state.state++;
+	/* turns the alarm on or off, keeping its time and days */
+	tmp_alarm = *alarms_get(alarm_nr);
 
-	/* Register RTC only if needed, saving CPU cycles.. */
-	if (alarm_state.state)
-		sys_messagebus_register(alarm_event, SYS_MSG_RTC_ALARM);
-	else
-		sys_messagebus_unregister(alarm_event);
-
-	if (alarm_state.alarm) {
-		display_symbol(0, LCD_ICON_ALARM, SEG_ON);
-		rtca_enable_alarm();
-	} else {
-		display_symbol(0, LCD_ICON_ALARM, SEG_OFF);
-		rtca_disable_alarm();
-	}
+	/* an alarm never set rings once */
+	if (!tmp_alarm.days)
+		tmp_alarm.days = ALARM_EVERYDAY;
 
-	if (alarm_state.chime) {
-		display_symbol(0, LCD_ICON_BEEPER2, SEG_ON);
-		display_symbol(0, LCD_ICON_BEEPER3, SEG_ON);
-	} else {
-		display_symbol(0, LCD_ICON_BEEPER2, SEG_OFF);
-		display_symbol(0, LCD_ICON_BEEPER3, SEG_OFF);
-	}
+	tmp_alarm.flags ^= ALARM_ON;
+	alarms_set(alarm_nr, &tmp_alarm);
 
+	refresh_screen();
 }
 
 
 /* Star button long press callback. */
 static void star_long_pressed()
 {
-	/* Save the current time in edit_buffer */
-	rtca_get_alarm(&tmp_hh, &tmp_mm);
+	/* Save the current alarm in edit_buffer */
+	tmp_alarm = *alarms_get(alarm_nr);
+
+	tmp_mode = alarm_mode(&tmp_alarm);
+	if (tmp_mode == ALARM_MODES)
+		tmp_mode = 0;
 
 	menu_editmode_start(&edit_save, edit_items);
 }
 
 
-void mod_alarm_init()
-{
-	menu_add_entry("ALARM", NULL, NULL,
-			&num_pressed,
-			&star_long_pressed,
-			NULL, NULL,
-			&alarm_activated,
-			&alarm_deactivated);
+const struct menu mod_alarm_menu = {
+	.name = "ALARM",
+	.up_btn_fn = &up_pressed,
+	.down_btn_fn = &down_pressed,
+	.num_btn_fn = &num_pressed,
+	.lstar_btn_fn = &star_long_pressed,
+	.activate_fn = &alarm_activated,
+	.deactivate_fn = &alarm_deactivated,
+};
 
+void mod_alarm_init(void)
+{
+	sys_messagebus_register(&alarm_event, SYS_MSG_ALARM);
 }
@@ -190,7 +190,7 @@ void display_altitude()
 	}
 #endif
 
-	display_chars(0, LCD_SEG_L1_3_0, _sprintf("%3s", alt), SEG_SET);
+	display_number(0, LCD_SEG_L1_3_0, alt, NUM_SIGNED | 1, SEG_SET);
 }
 
 
@@ -202,7 +202,7 @@ static void edit_offset_sel(void)
 	display_chars(1, LCD_SEG_L2_3_0, "OFST", SEG_SET);
 	
 	// Display the current offset
-	display_chars(1, LCD_SEG_L1_3_0, _sprintf("%3s", altitude.altitude + altitude.altitude_offset), SEG_SET); //FIXME
+	display_number(1, LCD_SEG_L1_3_0, altitude.altitude + altitude.altitude_offset, NUM_SIGNED | 1, SEG_SET); //FIXME
 }
 
 static void edit_offset_dsel(void)
@@ -216,7 +216,7 @@ static void edit_offset_set(int8_t step)
 	altitude.altitude_offset += step * 10;
 	
 	// Display the current offset
-	display_chars(1, LCD_SEG_L1_3_0, _sprintf("%3s", altitude.altitude + altitude.altitude_offset), SEG_SET); //FIXME
+	display_number(1, LCD_SEG_L1_3_0, altitude.altitude + altitude.altitude_offset, NUM_SIGNED | 1, SEG_SET); //FIXME
 
 }
 
@@ -243,7 +243,7 @@ static void edit_metric_dsel(void)
 static void edit_metric_set(int8_t step)
 {
 	// Switch from M to FT
-	display_altitude_metric = (step == 1) ? 0 : 1;
+	display_altitude_metric = (step > 0) ? 0 : 1;
 
 	// Display the current metric system used
 	display_chars(1, LCD_SEG_L1_3_0, (display_altitude_metric == 0 ? "METR " : "FEET"), SEG_SET);
@@ -383,16 +383,12 @@ static void altitude_deactivate()
 
 
 // *************************************************************************************************
-// @fn          mod_altiude_init
-// @brief       Init the module. Sets default values, register menu entry.
-// @return      none
+// @var         mod_altitude_menu
+// @brief       The menu entry of the module.
 // *************************************************************************************************
-void mod_altitude_init(void)
-{			
-	menu_add_entry(" ALTI",
-		NULL, NULL, NULL,
-		&altitude_edit,
-		NULL, NULL,
-		&altitude_activate,
-		&altitude_deactivate);
-}
+const struct menu mod_altitude_menu = {
+	.name = " ALTI",
+	.lstar_btn_fn = &altitude_edit,
+	.activate_fn = &altitude_activate,
+	.deactivate_fn = &altitude_deactivate,
+};
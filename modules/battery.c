@@ -30,7 +30,7 @@ static void display_battery(void)
 
 #ifdef CONFIG_MOD_BATTERY_SHOW_VOLTAGE
 	/* display battery voltage in line two (xx.x format) */
-	_printf(0, LCD_SEG_L2_3_0, "%4u", battery_info.voltage);
+	display_number(0, LCD_SEG_L2_3_0, battery_info.voltage, 1, SEG_SET);
 #endif
 }
 
@@ -74,8 +74,8 @@ static void battery_deactivate(void)
 	display_symbol(0, LCD_SYMB_BATTERY, SEG_OFF);
 }
 
-void mod_battery_init(void)
-{
-	menu_add_entry(" BATT", NULL, NULL, NULL, NULL, NULL, NULL,
-		&battery_activate, &battery_deactivate);
-}
+const struct menu mod_battery_menu = {
+	.name = " BATT",
+	.activate_fn = &battery_activate,
+	.deactivate_fn = &battery_deactivate,
+};
@@ -26,6 +26,15 @@
 #include <drivers/rtca.h>
 #include <drivers/display.h>
 
+#ifdef CONFIG_RTC_BCD
+/* the RTC counts in BCD, its digits go straight to the segments */
+#define clock_show(scr, segments, digits, field) \
+	display_bcd((scr), (segments), rtca_bcd.field, SEG_SET)
+#else
+#define clock_show(scr, segments, digits, field) \
+	display_number((scr), (segments), rtca_time.field, (digits), SEG_SET)
+#endif
+
 static void clock_event(enum sys_message msg)
 {
 #ifdef CONFIG_MOD_CLOCK_BLINKCOL
@@ -34,17 +43,17 @@ static void clock_event(enum sys_message msg)
 #endif
 
 	if (msg & SYS_MSG_RTC_YEAR)
-		_printf(1, LCD_SEG_L1_3_0, "%04u", rtca_time.year);
+		clock_show(1, LCD_SEG_L1_3_0, 4, year);
 #ifdef CONFIG_MOD_CLOCK_MONTH_FIRST
 	if (msg & SYS_MSG_RTC_MONTH)
-		_printf(0, LCD_SEG_L2_4_3, "%02u", rtca_time.mon);
+		clock_show(0, LCD_SEG_L2_4_3, 2, mon);
 	if (msg & SYS_MSG_RTC_DAY) {
-		_printf(0, LCD_SEG_L2_1_0, "%02u", rtca_time.day);
+		clock_show(0, LCD_SEG_L2_1_0, 2, day);
 #else
 	if (msg & SYS_MSG_RTC_MONTH)
-		_printf(0, LCD_SEG_L2_1_0, "%02u", rtca_time.mon);
+		clock_show(0, LCD_SEG_L2_1_0, 2, mon);
 	if (msg & SYS_MSG_RTC_DAY) {
-		_printf(0, LCD_SEG_L2_4_3, "%02u", rtca_time.day);
+		clock_show(0, LCD_SEG_L2_4_3, 2, day);
 
 #endif
 		_printf(1, LCD_SEG_L2_2_0, rtca_dow_str[rtca_time.dow], SEG_SET);
@@ -67,13 +76,19 @@ static void clock_event(enum sys_message msg)
 			if (tmp_hh == 0)
 				tmp_hh = 12;
 		}
-		_printf(0, LCD_SEG_L1_3_2, "%2u", tmp_hh);
+#ifdef CONFIG_RTC_BCD
+		display_bcd(0, LCD_SEG_L1_3_2, rtca_bcd_of(tmp_hh), SEG_SET);
+		if (tmp_hh < 10)
+			display_char(0, LCD_SEG_L1_3, ' ', SEG_SET);
+#else
+		display_number(0, LCD_SEG_L1_3_2, tmp_hh, 1, SEG_SET);
+#endif
 #else
-		_printf(0, LCD_SEG_L1_3_2, "%02u", rtca_time.hour);
+		clock_show(0, LCD_SEG_L1_3_2, 2, hour);
 #endif
 	}
 	if (msg & SYS_MSG_RTC_MINUTE)
-		_printf(0, LCD_SEG_L1_1_0, "%02u", rtca_time.min);
+		clock_show(0, LCD_SEG_L1_1_0, 2, min);
 }
 
 /********************* edit mode callbacks ********************************/
@@ -92,7 +107,7 @@ static void edit_yy_set(int8_t step)
 	*((uint8_t *)&rtca_time.year + 1) = 0x07;
 	helpers_loop((uint8_t *)&rtca_time.year, 220, 230, step);
 
-	_printf(1, LCD_SEG_L1_3_0, "%04u", rtca_time.year);
+	display_number(1, LCD_SEG_L1_3_0, rtca_time.year, 4, SEG_SET);
 }
 
 static void edit_mo_sel(void)
@@ -117,9 +132,9 @@ static void edit_mo_set(int8_t step)
 {
 	helpers_loop(&rtca_time.mon, 1, 12, step);
 #ifdef CONFIG_MOD_CLOCK_MONTH_FIRST
-	_printf(0, LCD_SEG_L2_4_3, "%02u", rtca_time.mon);
+	display_number(0, LCD_SEG_L2_4_3, rtca_time.mon, 2, SEG_SET);
 #else
-	_printf(0, LCD_SEG_L2_1_0, "%02u", rtca_time.mon);
+	display_number(0, LCD_SEG_L2_1_0, rtca_time.mon, 2, SEG_SET);
 #endif
 }
 
@@ -146,9 +161,9 @@ static void edit_dd_set(int8_t step)
 {
 	helpers_loop(&rtca_time.day, 1, rtca_get_max_days(rtca_time.mon, rtca_time.year), step);
 #ifdef CONFIG_MOD_CLOCK_MONTH_FIRST
-	_printf(0, LCD_SEG_L2_1_0, "%02u", rtca_time.day);
+	display_number(0, LCD_SEG_L2_1_0, rtca_time.day, 2, SEG_SET);
 #else
-	_printf(0, LCD_SEG_L2_4_3, "%02u", rtca_time.day);
+	display_number(0, LCD_SEG_L2_4_3, rtca_time.day, 2, SEG_SET);
 #endif
 }
 
@@ -165,7 +180,7 @@ static void edit_mm_set(int8_t step)
 {
 	helpers_loop(&rtca_time.min, 0, 59, step);
 
-	_printf(0, LCD_SEG_L1_1_0, "%02u", rtca_time.min);
+	display_number(0, LCD_SEG_L1_1_0, rtca_time.min, 2, SEG_SET);
 }
 
 static void edit_hh_sel(void)
@@ -185,15 +200,15 @@ static void edit_hh_set(int8_t step)
 	if (tmp_hh > 12) {
 		display_symbol(0, LCD_SYMB_AM, SEG_OFF);
 		display_symbol(0, LCD_SYMB_PM, SEG_SET);
-		_printf(0, LCD_SEG_L1_3_2, "%02u", tmp_hh-12);
+		display_number(0, LCD_SEG_L1_3_2, tmp_hh-12, 2, SEG_SET);
 	} else {
 		if (tmp_hh == 0) {
-			_printf(0, LCD_SEG_L1_3_2, "%02u", 12);
+			display_number(0, LCD_SEG_L1_3_2, 12, 2, SEG_SET);
 		} else {
 			if (tmp_hh > 9)
-				_printf(0, LCD_SEG_L1_3_2, "%02u", tmp_hh);
+				display_number(0, LCD_SEG_L1_3_2, tmp_hh, 2, SEG_SET);
 			else
-				_printf(0, LCD_SEG_L1_3_2, "%02u", tmp_hh);
+				display_number(0, LCD_SEG_L1_3_2, tmp_hh, 2, SEG_SET);
 		}
 		if (tmp_hh == 12) {
 			display_symbol(0, LCD_SYMB_AM, SEG_OFF);
@@ -205,7 +220,7 @@ static void edit_hh_set(int8_t step)
 	}
 	rtca_time.hour = tmp_hh;
 #else
-	_printf(0, LCD_SEG_L1_3_2, "%02u", rtca_time.hour);
+	display_number(0, LCD_SEG_L1_3_2, rtca_time.hour, 2, SEG_SET);
 #endif
 }
 
@@ -304,13 +319,10 @@ static void star_long_pressed()
 	menu_editmode_start(&edit_save, edit_items);
 }
 
-void mod_clock_init()
-{
-	menu_add_entry("CLOCK", NULL, NULL,
-			&num_pressed,
-			&star_long_pressed,
-			NULL, NULL,
-			&clock_activated,
-			&clock_deactivated);
-
-}
+const struct menu mod_clock_menu = {
+	.name = "CLOCK",
+	.num_btn_fn = &num_pressed,
+	.lstar_btn_fn = &star_long_pressed,
+	.activate_fn = &clock_activated,
+	.deactivate_fn = &clock_deactivated,
+};
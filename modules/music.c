@@ -45,9 +45,9 @@ static void music_deactivate()
 	display_clear(0, 2);
 }
 
-void mod_music_init(void)
-{
-	menu_add_entry("MUSIC", NULL, NULL, &num_press, NULL, NULL, NULL,
-						&music_activate,
-						&music_deactivate);
-}
+const struct menu mod_music_menu = {
+	.name = "MUSIC",
+	.num_btn_fn = &num_press,
+	.activate_fn = &music_activate,
+	.deactivate_fn = &music_deactivate,
+};
@@ -201,25 +201,6 @@ static uint8_t* hmac_sha1(uint8_t *data)
 	return hmac_sha;
 }
 
-static int days[12] ={0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
-
-uint32_t simple_mktime(int year, int month, int day, int hour, int minute, int second)
-{
-	//only works for year 2000 - 2032
-	uint32_t	result;
-
-	year += month / 12;
-	month %= 12;
-	result = (year - 1970) * 365 + days[month];
-	if (month <= 1) year--;
-
-	result += (year - 1968) / 4;
-	result += day - 1;
-	result  = ((result * 24 + hour) * 60 + minute) * 60 + second;
-
-	return result;
-}
-
 const  char     *key          = CONFIG_MOD_OTP_KEY;
 static uint32_t  last_time    = 0;
 static uint8_t   otp_data[]   = {0,0,0,0,0,0,0,0};
@@ -267,10 +248,8 @@ static void clock_event(enum sys_message msg)
     display_bits(0, LCD_SEG_L2_4, indicator[2*segment  ], SEG_SET);
     display_bits(0, LCD_SEG_L2_4, indicator[2*segment+1], BLINK_SET);
 
-    // Calculate timestamp
-	uint32_t time = simple_mktime(rtca_time.year, rtca_time.mon - 1, rtca_time.day,
-                                  rtca_time.hour, rtca_time.min    , rtca_time.sec);
-	time = (time - CONFIG_MOD_OTP_OFFSET * 3600) / 30;
+    // Timestamp, the RTC interrupt keeps the epoch
+	uint32_t time = (rtca_time.epoch - CONFIG_MOD_OTP_OFFSET * 3600) / 30;
 
     // Check if new code must be calculated
     if(time != last_time) {
@@ -279,11 +258,11 @@ static void clock_event(enum sys_message msg)
 
         // Draw first half on the top line
         uint16_t v = (otp_value / 1000) % 1000;
-        _printf(0, LCD_SEG_L1_2_0, "%03u", v);
+        display_number(0, LCD_SEG_L1_2_0, v, 3, SEG_SET);
         
         // Draw second half on the bottom line
         v = (otp_value % 1000);
-        _printf(0, LCD_SEG_L2_2_0,"%03u", v);
+        display_number(0, LCD_SEG_L2_2_0, v, 3, SEG_SET);
     }
 }
 
@@ -305,17 +284,9 @@ static void otp_deactivated()
     display_clear(0, 2);
 }
 
-void mod_otp_init()
-{
-    menu_add_entry("  OTP",
-        NULL,               /* up         */
-        NULL,               /* down       */
-        NULL,               /* num        */
-        NULL,               /* long star  */ 
-        NULL,               /* long num   */
-        NULL,               /* up-down    */
-        &otp_activated,     /* activate   */
-        &otp_deactivated    /* deactivate */
-    );
-}
+const struct menu mod_otp_menu = {
+    .name = "  OTP",
+    .activate_fn = &otp_activated,
+    .deactivate_fn = &otp_deactivated,
+};
 
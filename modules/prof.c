@@ -0,0 +1,114 @@
+/*
+    modules/prof.c: CPU time profiler results module for openchronos-ng
+
+	            http://www.openchronos-ng.sourceforge.net
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Line one shows the table entry and the field, line two its value:
+     CL: number of calls
+     TT: total kilocycles
+     WC: worst case cycles
+   UP/DOWN browse the entries, NUM switches the field, long NUM clears
+   the table. Entries are in order of first call, match them against
+   the function addresses in prof_table, see core/profile.h */
+
+#include <core/openchronos.h>
+#include <core/profile.h>
+
+#include <drivers/display.h>
+
+#ifdef CONFIG_PROFILE
+
+static uint8_t prof_entry;
+static uint8_t prof_field;
+
+static char const * const prof_field_str[] = {"CL", "TT", "WC"};
+
+/* display_number shows unsigned 16bit values */
+static uint16_t prof_clamp(uint32_t value)
+{
+	return (value > 65535 ? 65535 : value);
+}
+
+static void prof_display(void)
+{
+	struct prof_entry *e = &prof_table[prof_entry];
+	uint32_t value;
+
+	display_number(0, LCD_SEG_L1_3_2, prof_entry, 2, SEG_SET);
+	display_chars(0, LCD_SEG_L1_1_0, prof_field_str[prof_field], SEG_SET);
+
+	if (!e->fn) {
+		display_chars(0, LCD_SEG_L2_4_0, " ----", SEG_SET);
+		return;
+	}
+
+	if (prof_field == 0)
+		value = e->calls;
+	else if (prof_field == 1)
+		value = e->total / 1000;
+	else
+		value = e->worst;
+
+	display_number(0, LCD_SEG_L2_4_0, prof_clamp(value), 1, SEG_SET);
+}
+
+static void prof_up(void)
+{
+	helpers_loop(&prof_entry, 0, PROF_ENTRIES - 1, 1);
+	prof_display();
+}
+
+static void prof_down(void)
+{
+	helpers_loop(&prof_entry, 0, PROF_ENTRIES - 1, -1);
+	prof_display();
+}
+
+static void prof_num(void)
+{
+	helpers_loop(&prof_field, 0, 2, 1);
+	prof_display();
+}
+
+static void prof_lnum(void)
+{
+	prof_reset();
+	prof_display();
+}
+
+static void prof_activate(void)
+{
+	prof_display();
+}
+
+static void prof_deactivate(void)
+{
+	display_clear(0, 1);
+	display_clear(0, 2);
+}
+
+const struct menu mod_prof_menu = {
+	.name = " PROF",
+	.up_btn_fn = &prof_up,
+	.down_btn_fn = &prof_down,
+	.num_btn_fn = &prof_num,
+	.lnum_btn_fn = &prof_lnum,
+	.activate_fn = &prof_activate,
+	.deactivate_fn = &prof_deactivate,
+};
+
+#endif /* CONFIG_PROFILE */
@@ -73,6 +73,7 @@ static void updown_press()
 {
 	// Write RAM to indicate we will be downloading the RAM Updater first
 	display_chars(0, LCD_SEG_L1_3_0, " RAM", SEG_ON);
+	display_commit();
 
 	// Call RFBSL
 	CALL_RFSBL();
@@ -98,10 +99,9 @@ static void rfbsl_deactivate()
 	display_clear(0, 2);
 }
 
-void mod_rfbsl_init(void)
-{
-	menu_add_entry("RFBSL", NULL, NULL, NULL, NULL, NULL,
-						&updown_press,
-						&rfbsl_activate,
-						&rfbsl_deactivate);
-}
+const struct menu mod_rfbsl_menu = {
+	.name = "RFBSL",
+	.updown_btn_fn = &updown_press,
+	.activate_fn = &rfbsl_activate,
+	.deactivate_fn = &rfbsl_deactivate,
+};
@@ -0,0 +1,106 @@
+/*
+    modules/stack.c: stack monitor results module for openchronos-ng
+
+	            http://www.openchronos-ng.sourceforge.net
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* The first pages show the deepest stack use (USED) and the bytes that
+   were never used (FREE). The next ones show, for each function that
+   pushed the high water mark, its entry in stack_table and the depth
+   reached, see core/stackmon.h. UP/DOWN browse the pages, long NUM
+   clears the results and paints the stack again. */
+
+#include <core/openchronos.h>
+#include <core/stackmon.h>
+
+#include <drivers/display.h>
+
+#ifdef CONFIG_STACK_MONITOR
+
+/* pages before the table entries */
+enum stack_page {
+	STACK_PAGE_USED = 0,
+	STACK_PAGE_FREE,
+	STACK_PAGES
+};
+
+static uint8_t stack_page;
+
+static void stack_display(void)
+{
+	struct stack_entry *e;
+
+	if (stack_page == STACK_PAGE_USED) {
+		display_chars(0, LCD_SEG_L1_3_0, "USED", SEG_SET);
+		display_number(0, LCD_SEG_L2_4_0, stack_used(), 1, SEG_SET);
+		return;
+	}
+
+	if (stack_page == STACK_PAGE_FREE) {
+		display_chars(0, LCD_SEG_L1_3_0, "FREE", SEG_SET);
+		display_number(0, LCD_SEG_L2_4_0, stack_free(), 1, SEG_SET);
+		return;
+	}
+
+	e = &stack_table[stack_page - STACK_PAGES];
+
+	display_number(0, LCD_SEG_L1_3_0, stack_page - STACK_PAGES, 2, SEG_SET);
+
+	if (!e->fn)
+		display_chars(0, LCD_SEG_L2_4_0, " ----", SEG_SET);
+	else
+		display_number(0, LCD_SEG_L2_4_0, e->depth, 1, SEG_SET);
+}
+
+static void stack_up(void)
+{
+	helpers_loop(&stack_page, 0, STACK_PAGES + STACK_ENTRIES - 1, 1);
+	stack_display();
+}
+
+static void stack_down(void)
+{
+	helpers_loop(&stack_page, 0, STACK_PAGES + STACK_ENTRIES - 1, -1);
+	stack_display();
+}
+
+static void stack_lnum(void)
+{
+	stack_reset();
+	stack_display();
+}
+
+static void stack_activate(void)
+{
+	stack_display();
+}
+
+static void stack_deactivate(void)
+{
+	display_clear(0, 1);
+	display_clear(0, 2);
+}
+
+const struct menu mod_stack_menu = {
+	.name = "STACK",
+	.up_btn_fn = &stack_up,
+	.down_btn_fn = &stack_down,
+	.lnum_btn_fn = &stack_lnum,
+	.activate_fn = &stack_activate,
+	.deactivate_fn = &stack_deactivate,
+};
+
+#endif /* CONFIG_STACK_MONITOR */
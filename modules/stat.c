@@ -0,0 +1,106 @@
+/*
+    modules/stat.c: Wakeup statistics module for openchronos-ng
+
+	            http://www.openchronos-ng.sourceforge.net
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Line one shows the counter name, line two its value. UP/DOWN page
+   through the counters, long NUM clears them.
+   The time in LPM3 is UPTM * 60 - AWAK seconds */
+
+#include <core/openchronos.h>
+#include <core/wakestat.h>
+
+#include <drivers/display.h>
+
+#ifdef CONFIG_WAKE_STATS
+
+/* pages after the wake causes */
+enum stat_page {
+	STAT_LOOPS = WAKE_CAUSES,	/* mainloop wakeups */
+	STAT_AWAKE,			/* awake time, in seconds */
+	STAT_UPTIME,			/* uptime, in minutes */
+	STAT_PAGES
+};
+
+static char const * const stat_names[STAT_PAGES] = {
+	"RSEC", "RMIN", "RALM", "TCC0", "TCC1", "TCC4", "TOVF",
+	"BTN ", "ACC ", "PRES", "RADI", "ADC ",
+	"LOOP", "AWAK", "UPTM"
+};
+
+static uint8_t stat_page;
+
+static void stat_display(void)
+{
+	uint32_t value;
+
+	if (stat_page < WAKE_CAUSES)
+		value = wake_stats.count[stat_page];
+	else if (stat_page == STAT_LOOPS)
+		value = wake_stats.loops;
+	else if (stat_page == STAT_AWAKE)
+		value = wake_stats.awake >> 14;
+	else
+		value = wake_stat_uptime();
+
+	/* display_number shows unsigned 16bit values */
+	if (value > 65535)
+		value = 65535;
+
+	display_chars(0, LCD_SEG_L1_3_0, stat_names[stat_page], SEG_SET);
+	display_number(0, LCD_SEG_L2_4_0, value, 1, SEG_SET);
+}
+
+static void stat_up(void)
+{
+	helpers_loop(&stat_page, 0, STAT_PAGES - 1, 1);
+	stat_display();
+}
+
+static void stat_down(void)
+{
+	helpers_loop(&stat_page, 0, STAT_PAGES - 1, -1);
+	stat_display();
+}
+
+static void stat_lnum(void)
+{
+	wake_stat_reset();
+	stat_display();
+}
+
+static void stat_activate(void)
+{
+	stat_display();
+}
+
+static void stat_deactivate(void)
+{
+	display_clear(0, 1);
+	display_clear(0, 2);
+}
+
+const struct menu mod_stat_menu = {
+	.name = " STAT",
+	.up_btn_fn = &stat_up,
+	.down_btn_fn = &stat_down,
+	.lnum_btn_fn = &stat_lnum,
+	.activate_fn = &stat_activate,
+	.deactivate_fn = &stat_deactivate,
+};
+
+#endif /* CONFIG_WAKE_STATS */
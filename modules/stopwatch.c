@@ -42,6 +42,7 @@
 #include <core/openchronos.h>
 /* driver */
 #include <drivers/display.h>
+#include <drivers/rtca.h>
 
 /* Defines */
 
@@ -83,6 +84,11 @@ struct swatch_time sSwatch_time[MAX_LAPS + 2];
 extern struct swatch_conf sSwatch_conf;
 struct swatch_conf sSwatch_conf;
 
+/* rtca_mono_ms() when the counting time was last updated, and the
+ milliseconds not counted yet (less than a cent) */
+static uint32_t swatch_stamp;
+static uint8_t swatch_ms;
+
 /*
  * Helper Functions
  */
@@ -100,58 +106,81 @@ void drawStopWatchScreen(void) {
 				display_chars(0, LCD_SEG_L1_3_0, "STOP", SEG_SET);
 			} else {
 				display_chars(0, LCD_SEG_L1_3_2, "LP", SEG_SET);
-				_printf(0, LCD_SEG_L1_1_0, "%2u", sSwatch_conf.laps);
+				display_number(0, LCD_SEG_L1_1_0, sSwatch_conf.laps, 1, SEG_SET);
 			}
 
 		} else {
 			display_chars(0, LCD_SEG_L1_3_2, "LP", SEG_SET);
-			_printf(0, LCD_SEG_L1_1_0, "%2u", sSwatch_conf.lap_act +1);
+			display_number(0, LCD_SEG_L1_1_0, sSwatch_conf.lap_act +1, 1, SEG_SET);
 		}
 		if (sSwatch_time[SW_DISPLAYNG].minutes < 20) {
-			_printf(0, LCD_SEG_L2_5_4, "%02u",
-					sSwatch_time[SW_DISPLAYNG].minutes);
-			_printf(0, LCD_SEG_L2_3_2, "%02u",
-					sSwatch_time[SW_DISPLAYNG].seconds);
-			_printf(0, LCD_SEG_L2_1_0, "%02u",
-					sSwatch_time[SW_DISPLAYNG].cents);
+			display_number(0, LCD_SEG_L2_5_4,
+					sSwatch_time[SW_DISPLAYNG].minutes, 2, SEG_SET);
+			display_number(0, LCD_SEG_L2_3_2,
+					sSwatch_time[SW_DISPLAYNG].seconds, 2, SEG_SET);
+			display_number(0, LCD_SEG_L2_1_0,
+					sSwatch_time[SW_DISPLAYNG].cents, 2, SEG_SET);
 		} else {
-			_printf(0, LCD_SEG_L2_5_4, "%02u",
-					sSwatch_time[SW_DISPLAYNG].hours);
-			_printf(0, LCD_SEG_L2_3_2, "%02u",
-					sSwatch_time[SW_DISPLAYNG].minutes);
-			_printf(0, LCD_SEG_L2_1_0, "%02u",
-					sSwatch_time[SW_DISPLAYNG].seconds);
+			display_number(0, LCD_SEG_L2_5_4,
+					sSwatch_time[SW_DISPLAYNG].hours, 2, SEG_SET);
+			display_number(0, LCD_SEG_L2_3_2,
+					sSwatch_time[SW_DISPLAYNG].minutes, 2, SEG_SET);
+			display_number(0, LCD_SEG_L2_1_0,
+					sSwatch_time[SW_DISPLAYNG].seconds, 2, SEG_SET);
 		}
 	}
-	if (sSwatch_conf.state != SWATCH_MODE_OFF) {
-		if (sSwatch_time[SW_COUNTING].cents == 5) {
-			display_symbol(0, LCD_ICON_STOPWATCH, SEG_ON);
-		} else if (sSwatch_time[SW_COUNTING].cents == 55) {
-			display_symbol(0, LCD_ICON_STOPWATCH, SEG_OFF);
-		}
+	if (sSwatch_conf.state == SWATCH_MODE_ON) {
+		display_symbol(0, LCD_ICON_STOPWATCH,
+			sSwatch_time[SW_COUNTING].cents < 50 ? SEG_ON : SEG_OFF);
 	}
 }
 
-/* Function called every 5ms to increment the counters */
-static void stopwatch_event() {
+/* Adds the time elapsed since the last update to the counting time. The
+ RTC timestamp does not depend on the 20Hz ticks, so start, stop and laps
+ are exact to the cent, and it ignores clock edits and DST changes.
+ Subtractions only, the time between two updates is usually 50ms */
+static void update_stopwatch(void) {
+	struct swatch_time *t = &sSwatch_time[SW_COUNTING];
+	uint32_t now = rtca_mono_ms();
+	uint32_t ms = now - swatch_stamp + swatch_ms;
+
+	swatch_stamp = now;
+
+	/* the whole background time is counted when coming back */
+	for (; ms >= 3600000; ms -= 3600000) {
+		if (++t->hours >= 20)
+			t->hours = 0;
+	}
+	for (; ms >= 60000; ms -= 60000)
+		t->minutes++;
+	for (; ms >= 1000; ms -= 1000)
+		t->seconds++;
+	for (; ms >= 10; ms -= 10)
+		t->cents++;
+	swatch_ms = ms;
+
+	if (t->cents >= 100) {
+		t->cents -= 100;
+		t->seconds++;
+	}
+	if (t->seconds >= 60) {
+		t->seconds -= 60;
+		t->minutes++;
+	}
+	if (t->minutes >= 60) {
+		t->minutes -= 60;
+		if (++t->hours >= 20)
+			t->hours = 0;
+	}
+}
 
-	if (sSwatch_conf.state != SWATCH_MODE_OFF) {
-		sSwatch_time[SW_COUNTING].cents += 5;
-		if (sSwatch_time[SW_COUNTING].cents >= 100) {
-			sSwatch_time[SW_COUNTING].cents = 0;
-			sSwatch_time[SW_COUNTING].seconds++;
-			if (sSwatch_time[SW_COUNTING].seconds >= 60) {
-				sSwatch_time[SW_COUNTING].seconds = 0;
-				sSwatch_time[SW_COUNTING].minutes++;
-				if (sSwatch_time[SW_COUNTING].minutes >= 60) {
-					sSwatch_time[SW_COUNTING].minutes = 0;
-					sSwatch_time[SW_COUNTING].hours++;
-					if (sSwatch_time[SW_COUNTING].hours >= 20) {
-						sSwatch_time[SW_COUNTING].hours = 0;
-					}
-				}
-			}
-		}
+/* Function called every 50ms to refresh the counters, and every minute
+ in background to keep the blinking icon over the other modules */
+static void stopwatch_event() {
+	if (sSwatch_conf.state == SWATCH_MODE_BACKGROUND) {
+		display_symbol(0, LCD_ICON_STOPWATCH, SEG_ON | BLINK_ON);
+	} else if (sSwatch_conf.state != SWATCH_MODE_OFF) {
+		update_stopwatch();
 		drawStopWatchScreen();
 	}
 }
@@ -161,8 +190,10 @@ static void stopwatch_activated() {
 	display_symbol(0, LCD_SEG_L2_COL0, SEG_ON);
 	display_symbol(0, LCD_SEG_L2_COL1, SEG_ON);
 	if (sSwatch_conf.state == SWATCH_MODE_BACKGROUND) {
+		sys_messagebus_unregister(&stopwatch_event);
+		display_symbol(0, LCD_ICON_STOPWATCH, BLINK_OFF);
 		sSwatch_conf.state = SWATCH_MODE_ON;
-		return;
+		update_stopwatch();
 	}
 
 	sys_messagebus_register(&stopwatch_event, SYS_MSG_TIMER_20HZ);
@@ -174,12 +205,13 @@ static void stopwatch_deactivated() {
 	/* clean up screen */
 	display_clear(0, 1);
 	display_clear(0, 2);
+	sys_messagebus_unregister(&stopwatch_event);
 	if (sSwatch_conf.state == SWATCH_MODE_ON) {
+		/* counting needs no ticks, the hardware blinks the icon */
 		sSwatch_conf.state = SWATCH_MODE_BACKGROUND;
-		return;
+		display_symbol(0, LCD_ICON_STOPWATCH, SEG_ON | BLINK_ON);
+		sys_messagebus_register(&stopwatch_event, SYS_MSG_RTC_MINUTE);
 	} else {
-
-		sys_messagebus_unregister(&stopwatch_event);
 		display_symbol(0, LCD_ICON_STOPWATCH, SEG_OFF);
 		display_symbol(0, LCD_SEG_L2_COL0, SEG_OFF);
 		display_symbol(0, LCD_SEG_L2_COL1, SEG_OFF);
@@ -213,9 +245,11 @@ static void up_press() {
 }
 static void num_press() {
 	if (sSwatch_conf.state == SWATCH_MODE_OFF) {
+		swatch_stamp = rtca_mono_ms();
 		sSwatch_conf.state = SWATCH_MODE_ON;
 		sSwatch_conf.lap_act = SW_COUNTING;
 	} else {
+		update_stopwatch();
 		sSwatch_conf.state = SWATCH_MODE_OFF;
 	}
 	drawStopWatchScreen();
@@ -229,13 +263,19 @@ static void num_long_pressed() {
 	}
 }
 
+const struct menu mod_stopwatch_menu = {
+	.name = "ST WH",
+	.up_btn_fn = &up_press,
+	.down_btn_fn = &down_press,
+	.num_btn_fn = &num_press,
+	.lnum_btn_fn = &num_long_pressed,
+	.activate_fn = &stopwatch_activated,
+	.deactivate_fn = &stopwatch_deactivated,
+};
+
 void mod_stopwatch_init(void) {
 	sSwatch_conf.state = SWATCH_MODE_OFF;
 	clear_stopwatch();
-
-	menu_add_entry("ST WH", &up_press, &down_press, &num_press, NULL,
-			&num_long_pressed, NULL, &stopwatch_activated,
-			&stopwatch_deactivated);
 }
 
 /*
@@ -247,11 +287,13 @@ void clear_stopwatch(void) {
 	sSwatch_time[SW_COUNTING].hours = 0;
 	sSwatch_time[SW_COUNTING].minutes = 0;
 	sSwatch_time[SW_COUNTING].seconds = 0;
+	swatch_ms = 0;
 	sSwatch_conf.laps = 0;
 	sSwatch_conf.lap_act = SW_COUNTING;
 }
 
 void increment_lap_stopwatch(void) {
+	update_stopwatch();
 	sSwatch_time[sSwatch_conf.laps] = sSwatch_time[SW_COUNTING];
 	if (sSwatch_conf.laps < (MAX_LAPS - 1)) {
 		sSwatch_conf.laps++;
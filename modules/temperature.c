@@ -167,7 +167,7 @@ void display_temperature(void)
 
 
 	// Display result in xx.x format
-	display_chars(0, LCD_SEG_L1_3_1, _sprintf("%2s", temp_inmetric), SEG_ON);
+	display_number(0, LCD_SEG_L1_3_1, temp_inmetric, NUM_SIGNED | 2, SEG_ON);
 }
 
 
@@ -187,7 +187,7 @@ static void edit_offset_sel(void)
 	display_chars(1, LCD_SEG_L2_3_0, "OFST", SEG_SET);
 	
 	// Display the current offset
-	display_chars(1, LCD_SEG_L1_3_0, _sprintf("%2s", temperature.offset / 10), SEG_SET);
+	display_number(1, LCD_SEG_L1_3_1, temperature.offset / 10, NUM_SIGNED | 1, SEG_SET);
 }
 
 
@@ -213,7 +213,7 @@ static void edit_offset_set(int8_t step)
 	temperature.offset += step * 10;
 	
 	// Display the current offset
-	display_chars(1, LCD_SEG_L1_3_0, _sprintf("%2s", temperature.offset / 10), SEG_SET);
+	display_number(1, LCD_SEG_L1_3_1, temperature.offset / 10, NUM_SIGNED | 1, SEG_SET);
 }
 
 
@@ -257,7 +257,7 @@ static void edit_metric_dsel(void)
 static void edit_metric_set(int8_t step)
 {
 	// Switch from °C to °F
-	temp_display_metric = (step == 1) ? 0 : 1;
+	temp_display_metric = (step > 0) ? 0 : 1;
 
 	// Display the current metric system used
 	display_chars(1, LCD_SEG_L1_3_0, (temp_display_metric == 0 ? "CELS " : "FARH"), SEG_SET);
@@ -374,16 +374,12 @@ static void temperature_edit(void)
 
 
 //* ************************************************************************************************
-/// @fn			mod_temperature_init(void)
-/// @brief		Init the module. Sets default values, register menu entry.
-/// @return		none
+/// @var		mod_temperature_menu
+/// @brief		The menu entry of the module.
 //* ************************************************************************************************
-void mod_temperature_init(void)
-{			
-	menu_add_entry(" TEMP",
-		NULL, NULL, NULL,
-		&temperature_edit,
-		NULL, NULL,
-		&temperature_activate,
-		&temperature_deactivate);
-}
+const struct menu mod_temperature_menu = {
+	.name = " TEMP",
+	.lstar_btn_fn = &temperature_edit,
+	.activate_fn = &temperature_activate,
+	.deactivate_fn = &temperature_deactivate,
+};
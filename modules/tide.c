@@ -135,15 +135,15 @@ void drawScreen(void)
 	/* line1 time */
 	if (leftUntilHigh < leftUntilLow) {
 		/* show time till high */
-		_printf(0, LCD_SEG_L1_3_2, "%02u", highTide.hoursLeft);
-		_printf(0, LCD_SEG_L1_1_0, "%02u", highTide.minutesLeft);
+		display_number(0, LCD_SEG_L1_3_2, highTide.hoursLeft, 2, SEG_SET);
+		display_number(0, LCD_SEG_L1_1_0, highTide.minutesLeft, 2, SEG_SET);
 
 		display_symbol(0, LCD_SYMB_MAX, SEG_ON);
 
 	} else {
 		/* show time till low */
-		_printf(0, LCD_SEG_L1_3_2, "%02u", lowTide.hoursLeft);
-		_printf(0, LCD_SEG_L1_1_0, "%02u", lowTide.minutesLeft);
+		display_number(0, LCD_SEG_L1_3_2, lowTide.hoursLeft, 2, SEG_SET);
+		display_number(0, LCD_SEG_L1_1_0, lowTide.minutesLeft, 2, SEG_SET);
 
 		display_symbol(0, LCD_UNIT_L2_MI, SEG_ON);
 	}
@@ -155,8 +155,8 @@ void drawScreen(void)
 
 	/** screen 1 **/
 	/* line 1 time till low */
-	_printf(1, LCD_SEG_L1_3_2, "%02u", lowTide.hoursLeft);
-	_printf(1, LCD_SEG_L1_1_0, "%02u", lowTide.minutesLeft);
+	display_number(1, LCD_SEG_L1_3_2, lowTide.hoursLeft, 2, SEG_SET);
+	display_number(1, LCD_SEG_L1_1_0, lowTide.minutesLeft, 2, SEG_SET);
 
 	display_symbol(1, LCD_UNIT_L2_MI, SEG_ON);
 
@@ -165,8 +165,8 @@ void drawScreen(void)
 												% twentyFourHoursInMinutes;
 	struct Tide lowTideTime = timeFromMinutes(lowTideTimeInMinutes);
 
-	_printf(1, LCD_SEG_L2_3_2, "%02u", lowTideTime.hoursLeft);
-	_printf(1, LCD_SEG_L2_1_0, "%02u", lowTideTime.minutesLeft);
+	display_number(1, LCD_SEG_L2_3_2, lowTideTime.hoursLeft, 2, SEG_SET);
+	display_number(1, LCD_SEG_L2_1_0, lowTideTime.minutesLeft, 2, SEG_SET);
 
 	blinkCol(1, 1);
 	blinkCol(1, 2);
@@ -174,8 +174,8 @@ void drawScreen(void)
 
 	/** screen 2 **/
 	/* Line 1 time high */
-	_printf(2, LCD_SEG_L1_3_2, "%02u", highTide.hoursLeft);
-	_printf(2, LCD_SEG_L1_1_0, "%02u", highTide.minutesLeft);
+	display_number(2, LCD_SEG_L1_3_2, highTide.hoursLeft, 2, SEG_SET);
+	display_number(2, LCD_SEG_L1_1_0, highTide.minutesLeft, 2, SEG_SET);
 	display_symbol(2, LCD_SYMB_MAX, SEG_ON);
 
 	/* line 2 calculate time of next high */
@@ -183,8 +183,8 @@ void drawScreen(void)
 												% twentyFourHoursInMinutes;
 	struct Tide highTideTime = timeFromMinutes(highTideTimeInMinutes);
 
-	_printf(2, LCD_SEG_L2_3_2, "%02u", highTideTime.hoursLeft);
-	_printf(2, LCD_SEG_L2_1_0, "%02u", highTideTime.minutesLeft);
+	display_number(2, LCD_SEG_L2_3_2, highTideTime.hoursLeft, 2, SEG_SET);
+	display_number(2, LCD_SEG_L2_1_0, highTideTime.minutesLeft, 2, SEG_SET);
 
 	blinkCol(2, 1);
 	blinkCol(2, 2);
@@ -227,7 +227,7 @@ void editHHDeselect(void)
 void editHHSet(int8_t step)
 {
 	helpers_loop(&(enteredTimeOfNextLow.hoursLeft), 0, 23, step);
-	_printf(0, LCD_SEG_L1_3_2, "%02u", enteredTimeOfNextLow.hoursLeft);
+	display_number(0, LCD_SEG_L1_3_2, enteredTimeOfNextLow.hoursLeft, 2, SEG_SET);
 }
 
 void editMMSelect(void)
@@ -243,7 +243,7 @@ void editMMDeselect(void)
 void editMMSet(int8_t step)
 {
 	helpers_loop(&(enteredTimeOfNextLow.minutesLeft), 0, 59, step);
-	_printf(0, LCD_SEG_L1_1_0, "%02u", enteredTimeOfNextLow.minutesLeft);
+	display_number(0, LCD_SEG_L1_1_0, enteredTimeOfNextLow.minutesLeft, 2, SEG_SET);
 }
 
 static struct menu_editmode_item editModeItems[] = {
@@ -281,8 +281,8 @@ void longStarButton(void)
 	enteredTimeOfNextLow = timeFromMinutes((nowInMinutes + leftUntilLow) % twentyFourHoursInMinutes);
 
 	editModeActivated = 1;
-	_printf(0, LCD_SEG_L1_3_2, "%02u", enteredTimeOfNextLow.hoursLeft);
-	_printf(0, LCD_SEG_L1_1_0, "%02u", enteredTimeOfNextLow.minutesLeft);
+	display_number(0, LCD_SEG_L1_3_2, enteredTimeOfNextLow.hoursLeft, 2, SEG_SET);
+	display_number(0, LCD_SEG_L1_1_0, enteredTimeOfNextLow.minutesLeft, 2, SEG_SET);
 	blinkCol(0, 1);
 	menu_editmode_start(&endEditing, editModeItems);
 }
@@ -325,10 +325,18 @@ void deactivate(void)
 	display_clear(0, 0);
 }
 
+const struct menu mod_tide_menu = {
+	.name = "TIDE",
+	.up_btn_fn = &buttonUp,
+	.down_btn_fn = &buttonDown,
+	.lstar_btn_fn = &longStarButton,
+	.activate_fn = &activate,
+	.deactivate_fn = &deactivate,
+};
+
 void mod_tide_init(void)
 {
 	sys_messagebus_register(&minuteTick, SYS_MSG_RTC_MINUTE);
-	menu_add_entry("TIDE", &buttonUp, &buttonDown, NULL, &longStarButton, NULL, NULL, &activate, &deactivate);
 	tide = timeFromMinutes(90); /* fullTideTime); */
 	minuteTick(); /* initla display setup */
 }
@@ -24,19 +24,21 @@
 # *************************************************************************************************
 #
 ###################################################################################################
-version = "0.1"
+version = "0.2"
 # Changelog:
 #   0.1 - first version
+#   0.2 - generate the menu table, read config/config.h without urwid
 ###################################################################################################
 
+import re
 import cfg_reader
 
 ###################################################################################################
 
-initcode = """\
+header = """\
 /**
 	@file		modinit.c
-	@brief		Module init
+	@brief		Module init and menu table
 	
 	@warning	GENERATED FILE, DO NOT EDIT !
  */
@@ -45,18 +47,23 @@ initcode = """\
 // *************************************************************************************************
 // Include section
 
+#include <core/openchronos.h>
+#include <core/modinit.h>
+
 
 // *************************************************************************************************
-// Defines section
+// Extern section
 
+"""
 
+table = """
 // *************************************************************************************************
 // Global Variable section
 
+const struct menu * const menu_table[] = {
+"""
 
-// *************************************************************************************************
-// Extern section
-
+initcode = """
 //* ************************************************************************************************
 /// @fn		mod_init(void)
 /// @brief	Call the init function of each module.
@@ -67,26 +74,65 @@ void mod_init(void)
 """
 
 ###################################################################################################
-# Main
-
-from config import OpenChronosConfigApp
-
-app = OpenChronosConfigApp()
-app.load_config()
-
-cfg = app.get_config()
 
-f = open('config/modinit.c', 'w')
+def read_defines(path):
+	"""Names defined in config/config.h"""
+	match = re.compile('^[\t ]*#[\t ]*define[\t ]+([a-zA-Z0-9_]+)')
+	defined = set()
+	for line in open(path):
+		m = match.search(line)
+		if m:
+			defined.add(m.group(1))
+	return defined
+
+def enabled_modules(defined):
+	"""Enabled modules whose dependencies are enabled too, in the order of get_modules()"""
+	depends = dict(cfg_reader.read_modules_config())
+	mods = []
+	for mod in cfg_reader.get_modules():
+		key = "CONFIG_MOD_%s" % mod.upper()
+		if key not in defined or key not in depends:
+			continue
+		if [dep for dep in depends[key]['depends'] if dep not in defined]:
+			continue
+		mods.append(mod)
+	return mods
+
+def exports(mod):
+	"""Which of mod_<mod>_init() and mod_<mod>_menu the module defines"""
+	src = open("modules/%s.c" % mod).read()
+	has_init = re.search(r"^void\s+mod_%s_init\s*\(" % mod, src, re.M) != None
+	has_menu = re.search(r"^const\s+struct\s+menu\s+mod_%s_menu\b" % mod, src, re.M) != None
+	return has_init, has_menu
+
+def write_modinit(config, path):
+	mods = [(mod,) + exports(mod) for mod in enabled_modules(read_defines(config))]
+
+	f = open(path, 'w')
+	f.write(header)
+
+	for mod, has_init, has_menu in mods:
+		if has_init:
+			f.write("void mod_%s_init(void);\n" % mod)
+		if has_menu:
+			f.write("extern const struct menu mod_%s_menu;\n" % mod)
+
+	f.write(table)
+	for mod, has_init, has_menu in mods:
+		if has_menu:
+			f.write("\t&mod_%s_menu,\n" % mod)
+	f.write("};\n\n")
+	f.write("const uint8_t menu_table_size = sizeof(menu_table) / sizeof(menu_table[0]);\n\n")
+
+	f.write(initcode)
+	for mod, has_init, has_menu in mods:
+		if has_init:
+			f.write("\tmod_%s_init();\n" % mod)
+	f.write("}\n")
+	f.close()
 
-f.write(initcode)
-
-for mod in cfg_reader.get_modules():
-	MOD = mod.upper()
-	try:
-		if cfg["CONFIG_MOD_%s" % MOD]["value"]:
-			f.write("\tmod_%s_init();\n" % (mod) )
-	except KeyError:
-		pass
+###################################################################################################
+# Main
 
-f.write("}\n")
-f.close()
\ No newline at end of file
+if __name__ == "__main__":
+	write_modinit('config/config.h', 'config/modinit.c')
@@ -0,0 +1,223 @@
+#!/usr/bin/env python2
+# encoding: utf-8
+# vim: set ts=4 :
+
+###################################################################################################
+# energy.py
+# Tool to estimate the battery life of firmware configurations
+#
+# *************************************************************************************************
+# This file is part of OpenChronos. This file is free software: you can
+# redistribute it and/or modify it under the terms of the GNU General Public
+# License as published by the Free Software Foundation, version 2.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the GNU General Public License along with
+# this program; if not, write to the Free Software Foundation, Inc., 51
+# Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+# *************************************************************************************************
+#
+# Each configuration (a config/config.h saved from "make config") is built with "make host",
+# then a scripted day of usage (day.txt) is replayed in the host simulation. The simulation
+# reports how long the hardware spent in each power state, which is multiplied by typical
+# datasheet currents. The firmware always starts at the same date, so runs are repeatable.
+#
+#	tools/energy/energy.py                       current configuration
+#	tools/energy/energy.py full.h minimal.h      saved configurations
+#	tools/energy/energy.py --save energy.txt     remember the results...
+#	tools/energy/energy.py --compare energy.txt  ...and fail when one got worse
+#
+# The CPU runs infinitely fast in the simulation: the time it is awake is estimated from the
+# number of wakeups and interrupts. Measure them on the watch with the PROF module and pass
+# them with --wakeup-cycles and --irq-cycles for a better estimate. The sensors and the
+# regulator are not accounted for.
+#
+###################################################################################################
+from __future__ import print_function
+
+version = "0.1"
+# Changelog:
+#   0.1 - first version
+###################################################################################################
+
+import optparse
+import os
+import shutil
+import subprocess
+import sys
+
+###################################################################################################
+
+# Typical currents at 3V, in uA
+CURRENTS = {
+	"active":	2900.0,		# CC430F613x datasheet, active mode, 12MHz, PMMCOREVx = 1, from flash
+	"lpm1":		95.0,		# CC430F613x datasheet, LPM1, DCO at 12MHz
+	"lpm3":		2.0,		# CC430F613x datasheet, LPM3, XT1 with RTC
+	"lcd":		2.5,		# CC430F613x datasheet, LCD_B 4-mux, no charge pump
+	"lcd_pump":	1.3,		# CC430F613x datasheet, LCD_B charge pump on top of the above
+	"adc":		150.0,		# CC430F613x datasheet, ADC12_A
+	"ref":		100.0,		# CC430F613x datasheet, REF_A at 1.5V
+	"buzzer":	2000.0,		# estimate, piezo driven by P2.7 at a few kHz
+	"radio_rx":	15000.0,	# CC430F613x datasheet, radio RX at 868MHz
+	"radio_tx":	17000.0,	# CC430F613x datasheet, radio TX at 868MHz, 0dBm
+}
+
+# MCLK frequency, see init_application()
+MCLK_HZ = 12000000
+
+# CR2032 nominal capacity, in mAh
+CAPACITY = 225.0
+
+# The firmware is built as if it was this date, day.txt relies on it
+RTCA_NOW = "2013-01-07 06:00"
+
+DAY = 86400
+
+###################################################################################################
+
+def build(name, config):
+	"""Build the host simulation of a configuration, return the executable"""
+	outdir = "build/energy/%s" % name
+	saved = {}
+
+	if config != os.path.abspath("config/config.h"):
+		for path in ("config/config.h", "config/modinit.c"):
+			if os.path.exists(path):
+				saved[path] = open(path).read()
+		shutil.copyfile(config, "config/config.h")
+		subprocess.check_call([sys.executable, "tools/config/make_modinit.py"])
+
+	env = dict(os.environ)
+	env["RTCA_NOW"] = RTCA_NOW
+
+	try:
+		proc = subprocess.Popen(["make", "host", "OUTDIR=%s" % outdir], env=env,
+			stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+		out = proc.communicate()[0]
+	finally:
+		for path, data in saved.items():
+			open(path, "w").write(data)
+
+	if proc.returncode != 0:
+		sys.stdout.write(out.decode("utf-8", "replace"))
+		if os.path.exists("Build.log"):
+			sys.stdout.write(open("Build.log").read())
+		raise RuntimeError("%s: build failed" % config)
+
+	return "%s/host/openchronos" % outdir
+
+def simulate(binary, script):
+	"""Replay a script, return the time spent in each power state"""
+	proc = subprocess.Popen([binary, "-q", "-e", "-t", str(DAY), script],
+		stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+	out, err = proc.communicate()
+
+	if proc.returncode != 0:
+		sys.stderr.write(err.decode("utf-8", "replace"))
+		raise RuntimeError("%s: simulation failed" % binary)
+
+	states = {}
+	for line in out.decode("utf-8", "replace").splitlines():
+		words = line.split()
+		if len(words) == 3 and words[0] == "energy":
+			states[words[1]] = float(words[2])
+
+	return states
+
+def charge(states, wakeup_cycles, irq_cycles):
+	"""Charge used per day by each consumer, in uAh"""
+	awake = (states["wakeups"] * wakeup_cycles + states["interrupts"] * irq_cycles) / float(MCLK_HZ)
+
+	# The CPU was asleep while it ran the estimated cycles
+	times = dict(states)
+	times["active"] += awake
+	times["lpm3"] = max(0.0, times["lpm3"] - awake)
+
+	scale = DAY / states["time"]
+	return dict((key, CURRENTS[key] * times[key] * scale / 3600.0) for key in CURRENTS)
+
+###################################################################################################
+# Main
+
+def main():
+	parser = optparse.OptionParser(usage="%prog [options] [config.h ...]")
+	parser.add_option("-s", "--script", default="tools/energy/day.txt",
+		help="day of usage to replay [%default]")
+	parser.add_option("-c", "--capacity", type="float", default=CAPACITY,
+		help="battery capacity in mAh [%default]")
+	parser.add_option("-w", "--wakeup-cycles", type="int", default=400,
+		help="MCLK cycles of a mainloop pass [%default]")
+	parser.add_option("-i", "--irq-cycles", type="int", default=150,
+		help="MCLK cycles of an interrupt [%default]")
+	parser.add_option("-v", "--verbose", action="store_true",
+		help="show the charge used by each consumer")
+	parser.add_option("--save", metavar="FILE",
+		help="write the results to FILE")
+	parser.add_option("--compare", metavar="FILE",
+		help="compare with results saved in FILE, fail on regressions")
+	parser.add_option("--tolerance", type="float", default=2.0,
+		help="regression threshold for --compare, in percent [%default]")
+	opts, configs = parser.parse_args()
+
+	configs = [os.path.abspath(config) for config in configs]
+	if opts.script != parser.defaults["script"]:
+		opts.script = os.path.abspath(opts.script)
+
+	# Paths are relative to the top directory
+	os.chdir(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", ".."))
+
+	if not configs:
+		configs = [os.path.abspath("config/config.h")]
+
+	results = []
+	for config in configs:
+		name = os.path.splitext(os.path.basename(config))[0]
+		states = simulate(build(name, config), opts.script)
+		used = charge(states, opts.wakeup_cycles, opts.irq_cycles)
+		total = sum(used.values())
+		results.append((name, total))
+
+		print("%-20s %8.1f uAh/day %8.0f days on %.0fmAh" %
+			(name, total, opts.capacity * 1000 / total, opts.capacity))
+
+		if opts.verbose:
+			for key in sorted(used, key=used.get, reverse=True):
+				print("    %-10s %8.2f uAh/day %5.1f%%" % (key, used[key], used[key] * 100 / total))
+			print("    %-10s %8d" % ("wakeups", states["wakeups"]))
+			print("    %-10s %8d" % ("interrupts", states["interrupts"]))
+
+	if opts.save:
+		f = open(opts.save, "w")
+		for name, total in results:
+			f.write("%s %.3f\n" % (name, total))
+		f.close()
+
+	if opts.compare:
+		before = {}
+		for line in open(opts.compare):
+			words = line.split()
+			if len(words) == 2:
+				before[words[0]] = float(words[1])
+
+		failed = False
+		for name, total in results:
+			if name not in before:
+				continue
+			change = (total - before[name]) * 100 / before[name]
+			print("%-20s %+7.2f%%" % (name, change))
+			if change > opts.tolerance:
+				failed = True
+
+		if failed:
+			print("Power regression above %.1f%%" % opts.tolerance)
+			return 1
+
+	return 0
+
+if __name__ == "__main__":
+	sys.exit(main())
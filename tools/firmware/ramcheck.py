@@ -0,0 +1,97 @@
+#!/usr/bin/env python2
+# encoding: utf-8
+# vim: set ts=4 :
+
+###################################################################################################
+# ramcheck.py
+# Tool to check the RAM used by the firmware against the size of the RAM
+#
+# *************************************************************************************************
+# This file is part of OpenChronos. This file is free software: you can
+# redistribute it and/or modify it under the terms of the GNU General Public
+# License as published by the Free Software Foundation, version 2.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the GNU General Public License along with
+# this program; if not, write to the Free Software Foundation, Inc., 51
+# Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+# *************************************************************************************************
+#
+# The firmware has no heap (malloc and free are wrapped away at link time, see Common.mk), so
+# the RAM holds the sections placed there by the linker and the stack. The sizes of the sections
+# are read from the ELF file, the stack size is the part of the RAM kept for it. The check fails
+# when they do not fit.
+#
+###################################################################################################
+version = "0.1"
+# Changelog:
+#   0.1 - first version
+###################################################################################################
+
+import optparse
+import sys
+
+import elf
+
+###################################################################################################
+
+# RAM of the CC430F6137
+RAM_START = 0x1C00
+RAM_SIZE = 4096
+
+###################################################################################################
+
+def ram_sections(elfobj, start, size):
+	"""Allocated sections placed in the RAM, as (name, size)"""
+	res = []
+	for section in elfobj.sections:
+		if not section.sh_flags & elf.ELFSection.SHF_ALLOC or not section.sh_size:
+			continue
+		if start <= section.sh_addr < start + size:
+			res.append((section.name, section.sh_size))
+	return res
+
+###################################################################################################
+# Main
+
+def main():
+	parser = optparse.OptionParser(usage="%prog [options] firmware.elf")
+	parser.add_option("-r", "--ram", type="int", default=RAM_SIZE,
+		help="RAM size in bytes [%default]")
+	parser.add_option("-s", "--stack", type="int", default=512,
+		help="bytes kept for the stack [%default]")
+	parser.add_option("-v", "--verbose", action="store_true",
+		help="show the size of each section")
+	opts, args = parser.parse_args()
+
+	if len(args) != 1:
+		parser.error("an ELF file is required")
+
+	elfobj = elf.ELFObject()
+	elfobj.fromFile(open(args[0], "rb"))
+
+	sections = ram_sections(elfobj, RAM_START, opts.ram)
+	used = sum([size for name, size in sections]) + opts.stack
+
+	if opts.verbose:
+		for name, size in sections:
+			print "%-10s %5d" % (name, size)
+		print "%-10s %5d" % ("stack", opts.stack)
+
+	print "RAM: %s + stack %d = %d of %d bytes" % (
+		" + ".join(["%s %d" % (name, size) for name, size in sections]) or "nothing",
+		opts.stack, used, opts.ram)
+
+	if used > opts.ram:
+		print "RAM budget exceeded by %d bytes" % (used - opts.ram)
+		return 1
+
+	return 0
+
+if __name__ == "__main__":
+	sys.exit(main())
@@ -0,0 +1,236 @@
+#!/usr/bin/env python2
+# encoding: utf-8
+# vim: set ts=4 :
+
+###################################################################################################
+# trace.py
+# Tool to turn the event trace of the watch into a host simulation script
+#
+# *************************************************************************************************
+# This file is part of OpenChronos. This file is free software: you can
+# redistribute it and/or modify it under the terms of the GNU General Public
+# License as published by the Free Software Foundation, version 2.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the GNU General Public License along with
+# this program; if not, write to the Free Software Foundation, Inc., 51
+# Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+# *************************************************************************************************
+#
+# A firmware built with CONFIG_TRACE records the messages delivered by the mainloop and the
+# buttons it consumed (see core/trace.h). This tool reads the trace from the watch with mspdebug,
+# or from a file holding the output of "md trace", and writes a script for the host simulation
+# that presses the same buttons at the same times. The delivered messages are written as
+# comments, so the script of a trace taken in the simulation (openchronos -T) can be compared
+# with the one of the field trace:
+#
+#	tools/trace/trace.py -o field.txt
+#	build/host/openchronos -q -T replay.dump field.txt
+#	tools/trace/trace.py replay.dump | diff field.txt -
+#
+###################################################################################################
+from __future__ import print_function
+
+version = "0.2"
+# Changelog:
+#   0.1 - first version
+#   0.2 - long presses are delivered while the button is held
+###################################################################################################
+
+import optparse
+import os
+import re
+import struct
+import subprocess
+import sys
+
+###################################################################################################
+
+# struct trace, see core/trace.h
+HEADER = "<HBB"
+ENTRY = "<BBBBHH"
+
+TRACE_EVENTS = 1
+TRACE_BUTTONS = 2
+
+# SYS_MSG_RTC_SECOND and SYS_MSG_RTC_MINUTE
+RTC_MESSAGES = 0x0006
+
+# TA0 counts ACLK / 2
+TA0_HZ = 16384.0
+TA0_WRAP = 65536 / TA0_HZ
+
+# Button pins, see drivers/ports.h; long presses are shifted by 5
+BUTTONS = [(0, "down"), (1, "num"), (2, "star"), (3, "backlight"), (4, "up")]
+LONG_SHIFT = 5
+
+# Time from reset to rtca_start() in the host simulation, the delays of init_application()
+RTC_START = 0.021
+
+# Press durations written to the script, below and above CONFIG_BUTTONS_LONG_PRESS_TIME
+SHORT_PRESS = 0.1
+LONG_PRESS = 0.4
+
+# A long press is delivered CONFIG_BUTTONS_LONG_PRESS_TIME (default 6/20s) after the press
+LONG_PRESS_TIME = 0.3
+
+###################################################################################################
+
+def messages():
+	"""Names of the message bits, from enum sys_message"""
+	names = {}
+	for line in open("core/openchronos.h"):
+		m = re.match(r"\s*SYS_MSG_(\w+)\s*=\s*BIT([0-9A-F])\b", line)
+		if m:
+			names[int(m.group(2), 16)] = m.group(1)
+	return names
+
+def read_dump(lines):
+	"""Bytes of a memory dump, as printed by mspdebug md"""
+	data = []
+	for line in lines:
+		if ":" not in line:
+			continue
+		for word in line.split(":", 1)[1].split("|")[0].split():
+			if not re.match(r"^[0-9a-fA-F]{2}$", word):
+				break
+			data.append(int(word, 16))
+	return bytearray(data)
+
+def read_target(driver, elf, size):
+	"""Read the trace from the watch"""
+	cmd = ["mspdebug", driver, "sym import %s" % elf, "md trace %d" % size]
+	proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+	out = proc.communicate()[0].decode("utf-8", "replace")
+	if proc.returncode != 0:
+		sys.stderr.write(out)
+		raise RuntimeError("mspdebug failed")
+	return out.splitlines()
+
+def decode(data):
+	"""Entries of the trace, oldest first, as (kind, seconds of day, ta0, data)"""
+	count, last, reserved = struct.unpack_from(HEADER, data, 0)
+	offset = struct.calcsize(HEADER)
+	size = (len(data) - offset) // struct.calcsize(ENTRY)
+
+	if size == 0 or size & (size - 1):
+		raise RuntimeError("%d bytes is not a trace" % len(data))
+
+	entries = []
+	for i in range(size):
+		at = offset + ((last + i) % size) * struct.calcsize(ENTRY)
+		kind, hour, minute, sec, ta0, value = struct.unpack_from(ENTRY, data, at)
+		if kind != 0:
+			entries.append((kind, hour * 3600 + minute * 60 + sec, ta0, value))
+
+	return count, entries
+
+def timeline(entries):
+	"""Seconds since the first entry, TA0 gives the fraction and the RTC the TA0 wraps"""
+	times = []
+	for i, (kind, rtc, ta0, value) in enumerate(entries):
+		if i == 0:
+			times.append(0.0)
+			continue
+
+		prev_rtc, prev_ta0 = entries[i - 1][1:3]
+		rtc_delta = (rtc - prev_rtc) % 86400
+		ta0_delta = ((ta0 - prev_ta0) & 0xffff) / TA0_HZ
+
+		# The RTC is exact to a second only, pick the number of TA0 wraps closest to it
+		wraps = max(0, int(round((rtc_delta - ta0_delta) / TA0_WRAP)))
+		times.append(times[-1] + ta0_delta + wraps * TA0_WRAP)
+
+	return times
+
+def clock(seconds):
+	seconds = int(seconds) % 86400
+	return "%02d:%02d:%02d" % (seconds // 3600, seconds // 60 % 60, seconds % 60)
+
+def script(count, entries, start, out):
+	"""Write the simulation script"""
+	names = messages()
+	times = timeline(entries)
+	first = entries[0][1]
+
+	# The firmware starts at the 59th second of the minute it was built, see rtca_init()
+	boot = (first - int(start) - 59) // 60 * 60 + 59
+
+	# RTC messages are delivered right when the RTC counts a second, they place the
+	# entries within the second
+	anchor = 0
+	for i, (kind, rtc, ta0, value) in enumerate(entries):
+		if kind == TRACE_EVENTS and value & RTC_MESSAGES:
+			anchor = i
+			break
+	start = (entries[anchor][1] - boot) % 86400 + RTC_START - times[anchor]
+
+	out.write("# %d entries, %d overwritten, from %s to %s\n" %
+		(len(entries), count - len(entries), clock(first), clock(first + times[-1])))
+	out.write("# build with RTCA_NOW=\"%s\" to start at the same time of day\n" %
+		clock(boot - 59)[:5])
+
+	for (kind, rtc, ta0, value), t in zip(entries, times):
+		t += start
+
+		if kind == TRACE_EVENTS:
+			bits = [names.get(b, "BIT%X" % b) for b in range(16) if value & (1 << b)]
+			out.write("# %10.3f  events %s\n" % (t, " ".join(bits)))
+
+		elif kind == TRACE_BUTTONS:
+			out.write("# %10.3f  buttons 0x%03x\n" % (t, value))
+			for pin, name in BUTTONS:
+				# The mainloop sees short presses when released, long ones while held
+				if value & (1 << (pin + LONG_SHIFT)):
+					out.write("%12.3f  hold   %s %.1f\n" % (t - LONG_PRESS_TIME, name, LONG_PRESS))
+				elif value & (1 << pin):
+					out.write("%12.3f  click  %s\n" % (t - SHORT_PRESS, name))
+
+	out.write("%12.3f  quit\n" % (start + times[-1] + 0.5))
+
+###################################################################################################
+# Main
+
+def main():
+	parser = optparse.OptionParser(usage="%prog [options] [dump]")
+	parser.add_option("-o", "--output", metavar="FILE",
+		help="write the script to FILE instead of stdout")
+	parser.add_option("-d", "--driver", default="rf2500",
+		help="mspdebug driver [%default]")
+	parser.add_option("-e", "--elf", default="build/openchronos.elf",
+		help="firmware running on the watch [%default]")
+	parser.add_option("-n", "--entries", type="int", default=32,
+		help="TRACE_SIZE of the firmware [%default]")
+	parser.add_option("-s", "--start", type="float", default=5.0,
+		help="minimum time of the first entry in the script, after the boot [%default]")
+	opts, args = parser.parse_args()
+
+	if args:
+		lines = open(args[0]).readlines()
+	if opts.output:
+		opts.output = os.path.abspath(opts.output)
+
+	# Paths are relative to the top directory
+	os.chdir(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", ".."))
+
+	if not args:
+		size = struct.calcsize(HEADER) + opts.entries * struct.calcsize(ENTRY)
+		lines = read_target(opts.driver, opts.elf, size)
+
+	count, entries = decode(read_dump(lines))
+	if not entries:
+		print("The trace is empty")
+		return 1
+
+	out = open(opts.output, "w") if opts.output else sys.stdout
+	script(count, entries, opts.start, out)
+
+	return 0
+
+if __name__ == "__main__":
+	sys.exit(main())
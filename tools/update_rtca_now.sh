@@ -1,5 +1,15 @@
 #!/bin/bash
 
+# RTCA_NOW="2013-01-07 06:00" builds with a fixed date, see tools/energy/energy.py
+now()
+{
+	if [ -n "$RTCA_NOW" ]; then
+		date -d "$RTCA_NOW" "$@"
+	else
+		date "$@"
+	fi
+}
+
 strip_zero()
 {
 	cat | sed 's|^0||'
@@ -23,12 +33,12 @@ cat << EOF > config/rtca_now.h
 // *************************************************************************************************
 // Defines section
 
-#define COMPILE_YEAR `date +%Y`
-#define COMPILE_MON `date +%m | strip_zero`
-#define COMPILE_DAY `date +%d | strip_zero`
-#define COMPILE_DOW `date +%u`
-#define COMPILE_HOUR `date +%H | strip_zero`
-#define COMPILE_MIN `date +%M | strip_zero`
+#define COMPILE_YEAR `now +%Y`
+#define COMPILE_MON `now +%m | strip_zero`
+#define COMPILE_DAY `now +%d | strip_zero`
+#define COMPILE_DOW `now +%u`
+#define COMPILE_HOUR `now +%H | strip_zero`
+#define COMPILE_MIN `now +%M | strip_zero`
 
 
 #endif /* __RTCA_NOW_H__ */